@@ -1,5 +1,8 @@
 #include "PersistentState.h"
 #include "midi/ChromaticPalette.h"
+#include "engine/RomanNumeral.h"
+#include "diagnostics/Trace.h"
+#include <algorithm>
 
 namespace chordpumper {
 
@@ -11,74 +14,261 @@ namespace {
     const juce::Identifier kProgressionType {"Progression"};
     const juce::Identifier kChordType {"Chord"};
     const juce::Identifier kWeightsType {"Weights"};
+    const juce::Identifier kBanksType {"Banks"};
+    const juce::Identifier kBankType {"Bank"};
 
     constexpr int kCurrentStateVersion = 2;
 }
 
-PersistentState::PersistentState()
-    : gridChords(chromaticPalette())
-    , lastPlayedChord{pitches::C, ChordType::Major}
+namespace {
+
+juce::String voicingToString(const std::vector<int>& voicing)
 {
+    juce::String voicingStr;
+    for (size_t j = 0; j < voicing.size(); ++j)
+    {
+        if (j > 0) voicingStr += ",";
+        voicingStr += juce::String(voicing[j]);
+    }
+    return voicingStr;
 }
 
-juce::ValueTree PersistentState::toValueTree() const
+std::vector<int> voicingFromString(const juce::String& voicingStr)
 {
-    juce::ValueTree root(kStateType);
-    root.setProperty("version", kCurrentStateVersion, nullptr);
+    std::vector<int> voicing;
+    if (voicingStr.isNotEmpty())
+    {
+        auto tokens = juce::StringArray::fromTokens(voicingStr, ",", "");
+        for (const auto& tok : tokens)
+            voicing.push_back(tok.getIntValue());
+    }
+    return voicing;
+}
 
+void writeChord(juce::ValueTree& node, const Chord& chord)
+{
+    node.setProperty("root", static_cast<int>(chord.root.letter), nullptr);
+    node.setProperty("accidental", static_cast<int>(chord.root.accidental), nullptr);
+    node.setProperty("type", static_cast<int>(chord.type), nullptr);
+}
+
+Chord readChord(const juce::ValueTree& node)
+{
+    Chord chord{pitches::C, ChordType::Major};
+    chord.root.letter = static_cast<NoteLetter>(static_cast<int>(node.getProperty("root", 0)));
+    chord.root.accidental = static_cast<int8_t>(static_cast<int>(node.getProperty("accidental", 0)));
+    chord.type = static_cast<ChordType>(static_cast<int>(node.getProperty("type", 0)));
+    return chord;
+}
+
+// Sections in the order toValueTree writes them
+constexpr PersistentState::Section kSectionOrder[] = {
+    PersistentState::kGridSection,
+    PersistentState::kMorphContextSection,
+    PersistentState::kBanksSection,
+    PersistentState::kProgressionSection,
+    PersistentState::kWeightsSection,
+};
+
+const juce::Identifier& sectionType(PersistentState::Section section)
+{
+    switch (section)
+    {
+        case PersistentState::kGridSection:         return kGridType;
+        case PersistentState::kMorphContextSection: return kMorphContextType;
+        case PersistentState::kBanksSection:        return kBanksType;
+        case PersistentState::kProgressionSection:  return kProgressionType;
+        default:                                    return kWeightsType;
+    }
+}
+
+juce::ValueTree writeGrid(const PersistentState& state)
+{
     juce::ValueTree grid(kGridType);
-    for (int i = 0; i < 64; ++i)
+    grid.setProperty("columns", state.gridSize.columns, nullptr);
+    grid.setProperty("rows", state.gridSize.rows, nullptr);
+    for (int i = 0; i < state.gridSize.cells(); ++i)
     {
         auto idx = static_cast<size_t>(i);
         juce::ValueTree pad(kPadType);
         pad.setProperty("index", i, nullptr);
-        pad.setProperty("root", static_cast<int>(gridChords[idx].root.letter), nullptr);
-        pad.setProperty("accidental", static_cast<int>(gridChords[idx].root.accidental), nullptr);
-        pad.setProperty("type", static_cast<int>(gridChords[idx].type), nullptr);
-        pad.setProperty("roman", juce::String(romanNumerals[idx]), nullptr);
+        writeChord(pad, state.gridChords[idx]);
+        pad.setProperty("roman", juce::String(state.romanNumerals[idx]), nullptr);
         grid.addChild(pad, -1, nullptr);
     }
-    root.addChild(grid, -1, nullptr);
+    return grid;
+}
 
-    if (hasMorphed)
-    {
-        juce::ValueTree morph(kMorphContextType);
-        morph.setProperty("root", static_cast<int>(lastPlayedChord.root.letter), nullptr);
-        morph.setProperty("accidental", static_cast<int>(lastPlayedChord.root.accidental), nullptr);
-        morph.setProperty("type", static_cast<int>(lastPlayedChord.type), nullptr);
+// Invalid when the grid still shows the palette
+juce::ValueTree writeMorphContext(const PersistentState& state)
+{
+    if (!state.hasMorphed)
+        return {};
 
-        juce::String voicingStr;
-        for (size_t j = 0; j < lastVoicing.size(); ++j)
-        {
-            if (j > 0) voicingStr += ",";
-            voicingStr += juce::String(lastVoicing[j]);
-        }
-        morph.setProperty("voicing", voicingStr, nullptr);
-        root.addChild(morph, -1, nullptr);
+    juce::ValueTree morph(kMorphContextType);
+    writeChord(morph, state.lastPlayedChord);
+    morph.setProperty("voicing", voicingToString(state.lastVoicing), nullptr);
+    return morph;
+}
+
+// Only banks that were morphed are written; the rest are the palette
+juce::ValueTree writeBanks(const PersistentState& state)
+{
+    juce::ValueTree banks(kBanksType);
+    banks.setProperty("active", state.activeBank, nullptr);
+    for (int b = 0; b < kNumGridBanks; ++b)
+    {
+        const auto& stored = state.storedBanks[static_cast<size_t>(b)];
+        if (!stored)
+            continue;
+        juce::ValueTree bank(kBankType);
+        bank.setProperty("index", b, nullptr);
+        writeChord(bank, stored->lastPlayedChord);
+        bank.setProperty("voicing", voicingToString(stored->lastVoicing), nullptr);
+        bank.setProperty("chords", juce::String::toHexString(stored->chords.data(),
+                                                             static_cast<int>(stored->chords.size()), 0),
+                         nullptr);
+        banks.addChild(bank, -1, nullptr);
     }
+    return banks;
+}
 
+juce::ValueTree writeProgression(const PersistentState& state)
+{
     juce::ValueTree prog(kProgressionType);
-    for (const auto& chord : progression)
+    prog.setProperty("syncToHost", state.syncToHost, nullptr);
+    for (const auto& chord : state.progression)
     {
         juce::ValueTree c(kChordType);
-        c.setProperty("root", static_cast<int>(chord.root.letter), nullptr);
-        c.setProperty("accidental", static_cast<int>(chord.root.accidental), nullptr);
-        c.setProperty("type", static_cast<int>(chord.type), nullptr);
+        writeChord(c, chord);
         c.setProperty("octaveOffset", chord.octaveOffset, nullptr);
         c.setProperty("roman",        juce::String(chord.romanNumeral), nullptr);
+        if (chord.lengthBeats > 0.0)
+            c.setProperty("lengthBeats", chord.lengthBeats, nullptr);
         prog.addChild(c, -1, nullptr);
     }
-    root.addChild(prog, -1, nullptr);
+    return prog;
+}
 
+juce::ValueTree writeWeights(const PersistentState& state)
+{
     juce::ValueTree w(kWeightsType);
-    w.setProperty("diatonic", static_cast<double>(weights.diatonic), nullptr);
-    w.setProperty("commonTones", static_cast<double>(weights.commonTones), nullptr);
-    w.setProperty("voiceLeading", static_cast<double>(weights.voiceLeading), nullptr);
-    root.addChild(w, -1, nullptr);
+    w.setProperty("diatonic", static_cast<double>(state.weights.diatonic), nullptr);
+    w.setProperty("commonTones", static_cast<double>(state.weights.commonTones), nullptr);
+    w.setProperty("voiceLeading", static_cast<double>(state.weights.voiceLeading), nullptr);
+    return w;
+}
 
+juce::ValueTree writeSection(const PersistentState& state, PersistentState::Section section)
+{
+    switch (section)
+    {
+        case PersistentState::kGridSection:         return writeGrid(state);
+        case PersistentState::kMorphContextSection: return writeMorphContext(state);
+        case PersistentState::kBanksSection:        return writeBanks(state);
+        case PersistentState::kProgressionSection:  return writeProgression(state);
+        default:                                    return writeWeights(state);
+    }
+}
+
+} // anonymous namespace
+
+PersistentState::PersistentState()
+    : gridChords(extendedChromaticPalette())
+    , lastPlayedChord{pitches::C, ChordType::Major}
+{
+    CHORDPUMPER_TRACE_SCOPE("PersistentState::PersistentState");
+}
+
+void PersistentState::switchBank(int bank)
+{
+    if (bank == activeBank || bank < 0 || bank >= kNumGridBanks)
+        return;
+
+    auto& outgoing = storedBanks[static_cast<size_t>(activeBank)];
+    if (hasMorphed)
+    {
+        outgoing.emplace();
+        outgoing->lastPlayedChord = lastPlayedChord;
+        outgoing->lastVoicing = lastVoicing;
+        for (size_t i = 0; i < gridChords.size(); ++i)
+            outgoing->chords[i] = chordIdOf(gridChords[i]);
+    }
+    else
+    {
+        outgoing.reset();
+    }
+
+    activeBank = bank;
+    auto& incoming = storedBanks[static_cast<size_t>(bank)];
+    if (incoming)
+    {
+        hasMorphed = true;
+        lastPlayedChord = incoming->lastPlayedChord;
+        lastVoicing = std::move(incoming->lastVoicing);
+        for (size_t i = 0; i < gridChords.size(); ++i)
+        {
+            gridChords[i] = chordFromId(incoming->chords[i]);
+            romanNumerals[i] = romanNumeral(lastPlayedChord, gridChords[i]);
+        }
+        incoming.reset();
+    }
+    else
+    {
+        hasMorphed = false;
+        lastPlayedChord = Chord{pitches::C, ChordType::Major};
+        lastVoicing.clear();
+        gridChords = extendedChromaticPalette();
+        romanNumerals.fill({});
+    }
+    markDirty(kGridSection | kMorphContextSection | kBanksSection);
+}
+
+juce::ValueTree PersistentState::toValueTree() const
+{
+    juce::ValueTree root(kStateType);
+    root.setProperty("version", kCurrentStateVersion, nullptr);
+    for (auto section : kSectionOrder)
+    {
+        auto node = writeSection(*this, section);
+        if (node.isValid())
+            root.addChild(node, -1, nullptr);
+    }
     return root;
 }
 
+bool PersistentState::updateValueTree(juce::ValueTree& tree)
+{
+    if (!tree.isValid())
+    {
+        tree = toValueTree();
+        dirtySections = 0;
+        return true;
+    }
+    if (dirtySections == 0)
+        return false;
+
+    // Sections are replaced where they were, so the tree keeps the order
+    // toValueTree writes, ahead of anything the caller appended
+    int position = 0;
+    for (auto section : kSectionOrder)
+    {
+        auto node = tree.getChildWithName(sectionType(section));
+        if ((dirtySections & section) != 0)
+        {
+            if (node.isValid())
+                tree.removeChild(node, nullptr);
+            node = writeSection(*this, section);
+            if (node.isValid())
+                tree.addChild(node, position, nullptr);
+        }
+        if (node.isValid())
+            position = tree.indexOf(node) + 1;
+    }
+    dirtySections = 0;
+    return true;
+}
+
 PersistentState PersistentState::fromValueTree(const juce::ValueTree& tree)
 {
     if (!tree.isValid() || tree.getType() != kStateType)
@@ -93,11 +283,15 @@ PersistentState PersistentState::fromValueTree(const juce::ValueTree& tree)
     auto grid = tree.getChildWithName(kGridType);
     if (grid.isValid())
     {
+        GridSize size{grid.getProperty("columns", 8), grid.getProperty("rows", 8)};
+        if (std::find(kGridSizes.begin(), kGridSizes.end(), size) != kGridSizes.end())
+            state.gridSize = size;
+
         for (int i = 0; i < grid.getNumChildren(); ++i)
         {
             auto pad = grid.getChild(i);
             int index = pad.getProperty("index", -1);
-            if (index < 0 || index >= 64) continue;
+            if (index < 0 || index >= kMaxGridCells) continue;
 
             auto idx = static_cast<size_t>(index);
             state.gridChords[idx].root.letter =
@@ -125,25 +319,38 @@ PersistentState PersistentState::fromValueTree(const juce::ValueTree& tree)
     if (morph.isValid())
     {
         state.hasMorphed = true;
-        state.lastPlayedChord.root.letter =
-            static_cast<NoteLetter>(static_cast<int>(morph.getProperty("root", 0)));
-        state.lastPlayedChord.root.accidental =
-            static_cast<int8_t>(static_cast<int>(morph.getProperty("accidental", 0)));
-        state.lastPlayedChord.type =
-            static_cast<ChordType>(static_cast<int>(morph.getProperty("type", 0)));
-
-        juce::String voicingStr = morph.getProperty("voicing", "");
-        if (voicingStr.isNotEmpty())
+        state.lastPlayedChord = readChord(morph);
+        state.lastVoicing = voicingFromString(morph.getProperty("voicing", ""));
+    }
+
+    auto banks = tree.getChildWithName(kBanksType);
+    if (banks.isValid())
+    {
+        state.activeBank = juce::jlimit(0, kNumGridBanks - 1, static_cast<int>(banks.getProperty("active", 0)));
+        for (int i = 0; i < banks.getNumChildren(); ++i)
         {
-            auto tokens = juce::StringArray::fromTokens(voicingStr, ",", "");
-            for (const auto& tok : tokens)
-                state.lastVoicing.push_back(tok.getIntValue());
+            auto bank = banks.getChild(i);
+            int index = bank.getProperty("index", -1);
+            if (index < 0 || index >= kNumGridBanks || index == state.activeBank) continue;
+
+            juce::MemoryBlock chords;
+            chords.loadFromHexString(bank.getProperty("chords", "").toString());
+            GridBank stored;
+            stored.lastPlayedChord = readChord(bank);
+            stored.lastVoicing = voicingFromString(bank.getProperty("voicing", ""));
+            for (size_t c = 0; c < stored.chords.size(); ++c)
+            {
+                auto id = c < chords.getSize() ? static_cast<ChordId>(chords[c]) : ChordId{0};
+                stored.chords[c] = id < kNumChordIds ? id : ChordId{0};
+            }
+            state.storedBanks[static_cast<size_t>(index)] = std::move(stored);
         }
     }
 
     auto prog = tree.getChildWithName(kProgressionType);
     if (prog.isValid())
     {
+        state.syncToHost = static_cast<bool>(prog.getProperty("syncToHost", false));
         for (int i = 0; i < prog.getNumChildren(); ++i)
         {
             auto c = prog.getChild(i);
@@ -156,6 +363,7 @@ PersistentState PersistentState::fromValueTree(const juce::ValueTree& tree)
                 static_cast<ChordType>(static_cast<int>(c.getProperty("type", 0)));
             chord.octaveOffset = static_cast<int>(c.getProperty("octaveOffset", 0));
             chord.romanNumeral = c.getProperty("roman", "").toString().toStdString();
+            chord.lengthBeats = static_cast<double>(c.getProperty("lengthBeats", 0.0));
             state.progression.push_back(chord);
         }
     }
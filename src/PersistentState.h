@@ -1,26 +1,79 @@
 #pragma once
 
 #include "engine/Chord.h"
+#include "engine/ChordId.h"
 #include "engine/MorphEngine.h"
 #include <juce_data_structures/juce_data_structures.h>
 #include <array>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace chordpumper {
 
+struct GridSize {
+    int columns = 8;
+    int rows = 8;
+
+    constexpr int cells() const { return columns * rows; }
+    bool operator==(const GridSize&) const = default;
+};
+
+// The layouts offered in the editor; the grid arrays hold the largest.
+inline constexpr std::array<GridSize, 4> kGridSizes = {{{4, 4}, {8, 4}, {8, 8}, {16, 8}}};
+inline constexpr int kMaxGridCells = 128;
+
+inline constexpr int kNumGridBanks = 4;
+
+// A grid bank that is not on screen: chords as ChordId bytes, with the roman
+// numerals and spellings derived again when it is shown. Banks that were never
+// morphed are not stored at all and come back as the chromatic palette.
+struct GridBank {
+    Chord lastPlayedChord{pitches::C, ChordType::Major};
+    std::vector<int> lastVoicing;
+    std::array<ChordId, kMaxGridCells> chords{};
+};
+
 struct PersistentState {
-    std::array<Chord, 64> gridChords;
-    std::array<std::string, 64> romanNumerals;
+    // Parts of the saved state, re-encoded only when marked dirty. Whoever
+    // changes a field marks its section; a new state starts all dirty.
+    enum Section : uint32_t {
+        kGridSection = 1 << 0,          // gridSize, gridChords, romanNumerals
+        kMorphContextSection = 1 << 1,  // hasMorphed, lastPlayedChord, lastVoicing
+        kBanksSection = 1 << 2,         // activeBank, storedBanks
+        kProgressionSection = 1 << 3,   // progression, syncToHost
+        kWeightsSection = 1 << 4,       // weights
+        kAllSections = (1 << 5) - 1,
+    };
+
+    GridSize gridSize;
+    // The grid fields below hold the active bank in full
+    int activeBank = 0;
+    std::array<std::optional<GridBank>, kNumGridBanks> storedBanks;
+    std::array<Chord, kMaxGridCells> gridChords;
+    std::array<std::string, kMaxGridCells> romanNumerals;
     Chord lastPlayedChord;
     std::vector<int> lastVoicing;
     std::vector<Chord> progression;
+    bool syncToHost = false;      // play the progression with the host transport
     MorphWeights weights;
     bool hasMorphed = false;
+    uint32_t dirtySections = kAllSections;
 
     PersistentState();
 
+    void markDirty(uint32_t sections) { dirtySections |= sections; }
+
+    // Packs the active bank away and unpacks the given one into the grid fields.
+    void switchBank(int bank);
+
     juce::ValueTree toValueTree() const;
+
+    // Brings a tree from toValueTree (or an invalid one) up to date by
+    // re-encoding only the dirty sections, then marks the state clean. Other
+    // children of the tree are left alone. Returns false if nothing changed.
+    bool updateValueTree(juce::ValueTree& tree);
     static PersistentState fromValueTree(const juce::ValueTree& tree);
 };
 
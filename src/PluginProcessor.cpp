@@ -1,17 +1,140 @@
 #include "PluginProcessor.h"
 #include "ui/PluginEditor.h"
+#include "diagnostics/RealtimeGuard.h"
+#include "diagnostics/Trace.h"
+#include <algorithm>
+#include <chrono>
 
 namespace chordpumper {
 
+namespace {
+
+// Arpeggio step lengths in quarter notes, matching the "arpRate" choices
+constexpr double kArpRates[] = {1.0, 0.5, 1.0 / 3.0, 0.25, 1.0 / 6.0, 0.125};
+
+} // anonymous namespace
+
 ChordPumperProcessor::ChordPumperProcessor()
     : AudioProcessor(BusesProperties()
-          .withOutput("Output", juce::AudioChannelSet::stereo(), true))
+          .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+          .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)),
+      parameters(*this, nullptr, "Parameters", createParameterLayout())
+{
+    diatonicWeight = parameters.getRawParameterValue("diatonicWeight");
+    commonToneWeight = parameters.getRawParameterValue("commonToneWeight");
+    voiceLeadingWeight = parameters.getRawParameterValue("voiceLeadingWeight");
+    complexity = parameters.getRawParameterValue("complexity");
+    playMode = parameters.getRawParameterValue("playMode");
+    strumAmount = parameters.getRawParameterValue("strumAmount");
+    strumUnit = parameters.getRawParameterValue("strumUnit");
+    strumDirection = parameters.getRawParameterValue("strumDirection");
+    arpPattern = parameters.getRawParameterValue("arpPattern");
+    arpRate = parameters.getRawParameterValue("arpRate");
+    arpGate = parameters.getRawParameterValue("arpGate");
+    ratchets = parameters.getRawParameterValue("ratchets");
+    mpeEnabled = parameters.getRawParameterValue("mpeOutput");
+    mpeChannelReuse = parameters.getRawParameterValue("mpeChannelReuse");
+    linkGroup = parameters.getRawParameterValue("linkGroup");
+    linkRole = parameters.getRawParameterValue("linkRole");
+    linkFollowMode = parameters.getRawParameterValue("linkFollowMode");
+    linkOctave = parameters.getRawParameterValue("linkOctave");
+
+    jassert(getParameters().size() <= 64);  // one bit each in pendingParameterChanges
+    for (auto* parameter : getParameters())
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+        rawParameterValues.push_back(ranged != nullptr ? parameters.getRawParameterValue(ranged->paramID) : nullptr);
+    }
+    publishSequence();
+}
+
+ChordPumperProcessor::~ChordPumperProcessor()
+{
+    harmonyLink.releaseLeadership(linkLeadGroup, linkInstanceId);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout ChordPumperProcessor::createParameterLayout()
+{
+    using juce::ParameterID;
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    const MorphWeights defaults;
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"diatonicWeight", 1}, "Diatonic Weight", juce::NormalisableRange<float>(0.0f, 1.0f), defaults.diatonic));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"commonToneWeight", 1}, "Common Tone Weight", juce::NormalisableRange<float>(0.0f, 1.0f),
+        defaults.commonTones));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"voiceLeadingWeight", 1}, "Voice Leading Weight", juce::NormalisableRange<float>(0.0f, 1.0f),
+        defaults.voiceLeading));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"complexity", 1}, "Complexity", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"playMode", 1}, "Play Mode", juce::StringArray{"Chord", "Strum", "Arpeggio"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"strumAmount", 1}, "Strum Time", juce::NormalisableRange<float>(0.0f, 240.0f, 1.0f), 30.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"strumUnit", 1}, "Strum Unit", juce::StringArray{"Milliseconds", "Ticks"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"strumDirection", 1}, "Strum Direction", juce::StringArray{"Up", "Down", "Alternate"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"arpPattern", 1}, "Arp Pattern",
+        juce::StringArray{"Up", "Down", "Up/Down", "As Played", "Repeat"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"arpRate", 1}, "Arp Rate", juce::StringArray{"1/4", "1/8", "1/8T", "1/16", "1/16T", "1/32"}, 3));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"arpGate", 1}, "Arp Gate", juce::NormalisableRange<float>(0.05f, 1.0f, 0.01f), 0.8f));
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        ParameterID{"ratchets", 1}, "Ratchets", 1, 4, 1));
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        ParameterID{"mpeOutput", 1}, "MPE Output", false));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"mpeChannelReuse", 1}, "MPE Channel Reuse",
+        juce::StringArray{"Round Robin", "Least Recently Used"}, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"linkGroup", 1}, "Link Group",
+        juce::StringArray{"Off", "1", "2", "3", "4", "5", "6", "7", "8"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"linkRole", 1}, "Link Role", juce::StringArray{"Lead", "Follow"}, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"linkFollowMode", 1}, "Link Follow Mode", juce::StringArray{"Re-voice", "Morph"}, 0));
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        ParameterID{"linkOctave", 1}, "Link Octave", 1, 6, 3));
+    return layout;
+}
+
+bool ChordPumperProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    const auto sidechain = layouts.getChannelSet(true, 0);
+    return sidechain.isDisabled()
+        || sidechain == juce::AudioChannelSet::mono()
+        || sidechain == juce::AudioChannelSet::stereo();
 }
 
-void ChordPumperProcessor::prepareToPlay(double /*sampleRate*/, int /*samplesPerBlock*/)
+void ChordPumperProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    keyboardState.reset();
+    currentSampleRate = sampleRate;
+    chordRecognizer.reset();
+    keyDetector.prepare(sampleRate);
+    chromagram.prepare(sampleRate, samplesPerBlock);
+    lastSidechainChord = kNoChord;
+    sequencer.prepare(sampleRate);
+    recorder.prepare(sampleRate);
+    performance.prepare(sampleRate);
+    performanceInput.ensureSize(4096);
+    performanceOutput.ensureSize(8192);
+    expressionInput.ensureSize(4096);
+    mpeOutput.prepare();
+    clapOutput.ensureSize(16384);
+    hostOutput.ensureSize(16384);
+    hostOutputStorage = nullptr;
+    clapNotes.reset();
+    heldNotes = {};
+    numLinkNotes = 0;
+    linkPublishPending = true;
+    perfCounters.audioLoad.reset();
 }
 
 void ChordPumperProcessor::releaseResources()
@@ -20,10 +143,424 @@ void ChordPumperProcessor::releaseResources()
 
 void ChordPumperProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    midiMessages.ensureSize(2048);
+    const RealtimeGuard::ScopedSection realtimeSection;
+    CHORDPUMPER_TRACE_SCOPE("processBlock");
+    const auto blockStart = std::chrono::steady_clock::now();
+    const int numSamples = buffer.getNumSamples();
+    const auto transport = readTransport();
+    beginBlock(transport, numSamples);
+
+    // The sidechain shares channels with the output, so analyse it before the
+    // buffer is cleared.
+    const auto sidechain = getBusBuffer(buffer, true, 0);
+    if (sidechain.getNumChannels() > 0)
+        analyseSidechain(sidechain.getArrayOfReadPointers(), sidechain.getNumChannels(),
+                         sidechain.getNumSamples());
+
     buffer.clear();
+
+    for (const auto metadata : midiMessages)
+        handleInputMessage(metadata.getMessage(), metadata.samplePosition);
+
+    // The host sizes midiMessages for what it sends, not for the strums,
+    // ratchets and MPE zone setup added here, so the output is rendered into
+    // storage sized in prepareToPlay and swapped in. A host that keeps its
+    // buffer passes that storage back, and later blocks render straight into it.
     midiMessages.clear();
-    keyboardState.processNextMidiBuffer(midiMessages, 0, buffer.getNumSamples(), true);
+    if (hostOutputStorage != nullptr && midiMessages.data.getRawDataPointer() == hostOutputStorage)
+    {
+        renderBlock(transport, numSamples, midiMessages);
+    }
+    else
+    {
+        hostOutput.clear();
+        renderBlock(transport, numSamples, hostOutput);
+        midiMessages.swapWith(hostOutput);
+        hostOutputStorage = midiMessages.data.getRawDataPointer();
+    }
+    measureLoad(blockStart, numSamples);
+}
+
+// CLAP hosts call this instead of processBlock. Events are read straight
+// from the host's queue and written straight to it, without the wrapper's
+// MidiBuffer and AudioBuffer conversion either way.
+clap_process_status ChordPumperProcessor::clap_direct_process(const clap_process* process) noexcept
+{
+    const RealtimeGuard::ScopedSection realtimeSection;
+    CHORDPUMPER_TRACE_SCOPE("clapDirectProcess");
+    const auto blockStart = std::chrono::steady_clock::now();
+    const int numSamples = static_cast<int>(process->frames_count);
+    const auto transport = readTransport(process->transport);
+    beginBlock(transport, numSamples);
+
+    if (process->audio_inputs_count > 0)
+    {
+        const auto& sidechain = process->audio_inputs[0];
+        if (sidechain.channel_count > 0 && sidechain.data32 != nullptr)
+            analyseSidechain(sidechain.data32, static_cast<int>(sidechain.channel_count), numSamples);
+    }
+
+    for (uint32_t port = 0; port < process->audio_outputs_count; ++port)
+    {
+        auto& output = process->audio_outputs[port];
+        if (output.data32 == nullptr)
+            continue;
+        for (uint32_t channel = 0; channel < output.channel_count; ++channel)
+            std::fill_n(output.data32[channel], numSamples, 0.0f);
+        output.constant_mask = ~uint64_t{0};
+    }
+
+    const auto* in = process->in_events;
+    for (uint32_t i = 0, n = in->size(in); i < n; ++i)
+    {
+        const auto* event = in->get(in, i);
+        juce::MidiMessage message;
+        if (event->space_id == CLAP_CORE_EVENT_SPACE_ID && event->type == CLAP_EVENT_PARAM_VALUE)
+            applyClapParameter(reinterpret_cast<const clap_event_param_value_t&>(*event));
+        else if (ClapNoteBridge::toMidiMessage(*event, message))
+            handleInputMessage(message, static_cast<int>(event->time));
+    }
+
+    clapOutput.clear();
+    renderBlock(transport, numSamples, clapOutput);
+    clapNotes.write(clapOutput, *process->out_events);
+    measureLoad(blockStart, numSamples);
+    return CLAP_PROCESS_CONTINUE;
+}
+
+// clap-juce-extensions registers each JUCE parameter as its CLAP cookie and
+// reports values in JUCE's normalised range. Listeners take locks, so the
+// audio thread only stores the value where processing reads it and leaves
+// the notification to flushClapParameterChanges.
+void ChordPumperProcessor::applyClapParameter(const clap_event_param_value_t& event)
+{
+    auto* parameter = static_cast<juce::AudioProcessorParameter*>(event.cookie);
+    if (parameter == nullptr)
+        return;
+
+    const auto value = static_cast<float>(event.value);
+    const int index = parameter->getParameterIndex();
+    if (parameter->getValue() == value || index < 0 || index >= static_cast<int>(rawParameterValues.size()))
+        return;
+
+    parameter->setValue(value);
+    if (auto* raw = rawParameterValues[static_cast<size_t>(index)])
+    {
+        auto* ranged = static_cast<juce::RangedAudioParameter*>(parameter);
+        raw->store(ranged->convertFrom0to1(value), std::memory_order_relaxed);
+    }
+    pendingParameterChanges.fetch_or(uint64_t{1} << index, std::memory_order_release);
+}
+
+void ChordPumperProcessor::flushClapParameterChanges()
+{
+    auto pending = pendingParameterChanges.exchange(0, std::memory_order_acquire);
+    const auto& params = getParameters();
+    for (int index = 0; pending != 0; ++index, pending >>= 1)
+    {
+        if ((pending & 1) != 0 && index < params.size())
+            params[index]->sendValueChangedMessageToListeners(params[index]->getValue());
+    }
+}
+
+void ChordPumperProcessor::beginBlock(const StripSequencer::Transport& transport, int numSamples)
+{
+    // Named once per thread; some hosts move processing between threads
+    if (Trace::isEnabled() && std::this_thread::get_id() != tracedAudioThread)
+    {
+        Trace::setThreadName("Audio");
+        tracedAudioThread = std::this_thread::get_id();
+    }
+
+    recorder.beginBlock(transport, numSamples);
+    expressionInput.clear();
+    inputNoteAdded = false;
+}
+
+// Follows chords heard on the sidechain.
+void ChordPumperProcessor::analyseSidechain(const float* const* channels, int numChannels, int numSamples)
+{
+    if (!chromagram.process(channels, numChannels, numSamples))
+        return;
+
+    auto heard = ChordRecognizer::lookup(chromagram.activePitchClasses(), chromagram.chordBassPitchClass());
+    if (heard.isValid() && heard.id != lastSidechainChord)
+        recognizedChord.store(packRecognizedChord(heard, ++recognitionSerial),
+                              std::memory_order_release);
+    lastSidechainChord = heard.id;
+}
+
+// Follows what the player is holding. Only note-ons trigger a new
+// recognition, so releasing a chord note by note does not re-name it.
+// Expression is kept for the chord voices in MPE mode.
+void ChordPumperProcessor::handleInputMessage(const juce::MidiMessage& message, int samplePosition)
+{
+    if (message.isNoteOn())
+    {
+        chordRecognizer.noteOn(message.getNoteNumber());
+        keyDetector.noteOn(message.getNoteNumber(), message.getFloatVelocity());
+        recorder.noteOn(message.getNoteNumber(), samplePosition);
+        inputNoteAdded = true;
+    }
+    else if (message.isNoteOff())
+    {
+        chordRecognizer.noteOff(message.getNoteNumber());
+        recorder.noteOff(message.getNoteNumber(), samplePosition);
+    }
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+    {
+        chordRecognizer.reset();
+        recorder.allNotesOff(samplePosition);
+    }
+    else if (message.isPitchWheel() || message.isChannelPressure() || message.isAftertouch()
+             || message.isControllerOfType(MpeOutput::kTimbreController))
+    {
+        expressionInput.addEvent(message, samplePosition);
+    }
+}
+
+// Everything after the host's input: recognition, the plugin's own notes and
+// the output stages. prepareToPlay pre-sizes the scratch buffers, so nothing
+// here allocates or locks.
+void ChordPumperProcessor::renderBlock(const StripSequencer::Transport& transport, int numSamples,
+                                       juce::MidiBuffer& output)
+{
+    if (inputNoteAdded)
+    {
+        auto recognized = chordRecognizer.recognize();
+        if (recognized.isValid())
+            recognizedChord.store(packRecognizedChord(recognized, ++recognitionSerial),
+                                  std::memory_order_release);
+    }
+
+    const bool followingLink = linkGroup->load() >= 1.0f && linkRole->load() >= 0.5f;
+    if (keyDetector.advance(numSamples) && !followingLink)
+        detectedKey.store(packKeyEstimate(keyDetector.estimate(), ++keySerial),
+                          std::memory_order_release);
+
+    performanceInput.clear();
+    performanceOutput.clear();
+
+    previewQueue.drain([this](const PreviewNoteQueue::Note& n) {
+        if (n.isNoteOn)
+        {
+            performanceInput.addEvent(juce::MidiMessage::noteOn(n.channel, n.note, n.velocity), 0);
+            recorder.noteOn(n.note, 0);
+        }
+        else
+        {
+            performanceInput.addEvent(juce::MidiMessage::noteOff(n.channel, n.note), 0);
+            recorder.noteOff(n.note, 0);
+        }
+    });
+
+    sequencer.process(transport, numSamples, performanceInput);
+    updateHarmonyLink();
+
+    // Strum or arpeggiate everything the plugin plays on its way out
+    performance.setSettings(readPerformanceSettings());
+    performance.process(performanceInput, transport, numSamples, performanceOutput);
+
+    mpeOutput.setEnabled(mpeEnabled->load() >= 0.5f);
+    mpeOutput.setPolicy(static_cast<MpeChannelAllocator::Policy>(static_cast<int>(mpeChannelReuse->load())));
+    mpeOutput.process(performanceOutput, expressionInput, numSamples, output);
+}
+
+// Leads or follows a link group (see HarmonyLink). A leader publishes
+// whenever the set of notes it plays changes; a follower plays the leader's
+// chord in its own register, or hands it to the editor to morph the grid.
+void ChordPumperProcessor::updateHarmonyLink()
+{
+    for (const auto metadata : performanceInput)
+    {
+        const auto message = metadata.getMessage();
+        if (!message.isNoteOnOrOff())
+            continue;
+        const auto note = static_cast<unsigned>(message.getNoteNumber());
+        const auto bit = uint64_t{1} << (note % 64);
+        auto& word = heldNotes[note / 64];
+        const auto before = word;
+        word = message.isNoteOn() ? (word | bit) : (word & ~bit);
+        linkPublishPending = linkPublishPending || word != before;
+    }
+
+    const int group = static_cast<int>(linkGroup->load()) - 1;
+    const bool leading = group >= 0 && linkRole->load() < 0.5f;
+    const bool following = group >= 0 && !leading;
+
+    if (linkLeadGroup != (leading ? group : -1))
+    {
+        harmonyLink.releaseLeadership(linkLeadGroup, linkInstanceId);
+        linkLeadGroup = -1;
+        if (leading && harmonyLink.claimLeadership(group, linkInstanceId))
+        {
+            linkLeadGroup = group;
+            linkPublishPending = true;
+        }
+    }
+
+    if (linkLeadGroup >= 0 && linkPublishPending)
+    {
+        HarmonyLink::Harmony harmony;
+        uint16_t pitchClasses = 0;
+        for (unsigned note = 0; note < 128 && harmony.numNotes < HarmonyLink::kMaxNotes; ++note)
+        {
+            if ((heldNotes[note / 64] >> (note % 64) & 1) == 0)
+                continue;
+            harmony.notes[harmony.numNotes++] = static_cast<uint8_t>(note);
+            pitchClasses |= static_cast<uint16_t>(1u << (note % 12));
+        }
+        harmony.chord = ChordRecognizer::lookup(pitchClasses, harmony.notes[0] % 12).id;
+        harmony.key = detectedKey.load(std::memory_order_relaxed);
+
+        // Passing notes that spell no chord leave the followers where they are
+        if (harmony.numNotes == 0 || harmony.chord != kNoChord)
+            harmonyLink.publish(linkLeadGroup, harmony);
+        linkPublishPending = false;
+    }
+
+    const bool revoicing = following && linkFollowMode->load() < 0.5f;
+    if (!revoicing)
+        releaseLinkNotes();
+    if (!following)
+    {
+        linkVersion = 0;
+        return;
+    }
+
+    HarmonyLink::Harmony harmony;
+    if (!harmonyLink.read(group, harmony, linkVersion))
+        return;
+
+    // Tonic and mode only; a new serial would re-trigger the editor's key following
+    const auto sameKey = [](uint32_t a, uint32_t b) { return (a & 0xffff) == (b & 0xffff); };
+    if (auto key = unpackKeyEstimate(harmony.key);
+        key.isValid() && !sameKey(harmony.key, detectedKey.load(std::memory_order_relaxed)))
+        detectedKey.store(packKeyEstimate(key, ++keySerial), std::memory_order_release);
+
+    if (revoicing)
+    {
+        releaseLinkNotes();
+        numLinkNotes = revoiceInRegister(harmony, static_cast<int>(linkOctave->load()), linkNotes);
+        for (int i = 0; i < numLinkNotes; ++i)
+            performanceInput.addEvent(juce::MidiMessage::noteOn(1, linkNotes[static_cast<size_t>(i)], 0.8f), 0);
+    }
+    else if (harmony.chord != kNoChord)
+    {
+        RecognizedChord linked;
+        linked.id = harmony.chord;
+        linked.bass = static_cast<int8_t>(harmony.notes[0] % 12);
+        linkedChord.store(packRecognizedChord(linked, ++linkSerial), std::memory_order_release);
+    }
+}
+
+void ChordPumperProcessor::releaseLinkNotes()
+{
+    for (int i = 0; i < numLinkNotes; ++i)
+        performanceInput.addEvent(juce::MidiMessage::noteOff(1, linkNotes[static_cast<size_t>(i)]), 0);
+    numLinkNotes = 0;
+}
+
+void ChordPumperProcessor::measureLoad(std::chrono::steady_clock::time_point blockStart, int numSamples)
+{
+    if (numSamples > 0)
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - blockStart;
+        perfCounters.audioLoad.add(static_cast<float>(elapsed.count() * currentSampleRate / numSamples));
+    }
+}
+
+// Also remembers the host's tempo and meter for export, whether or not the
+// transport is running.
+StripSequencer::Transport ChordPumperProcessor::readTransport()
+{
+    StripSequencer::Transport transport;
+    auto* playHead = getPlayHead();
+    if (playHead == nullptr)
+        return transport;
+
+    auto position = playHead->getPosition();
+    if (!position.hasValue())
+        return transport;
+
+    if (auto bpm = position->getBpm(); bpm.hasValue() && *bpm > 0.0)
+    {
+        transport.bpm = *bpm;
+        hostBpm.store(*bpm, std::memory_order_relaxed);
+    }
+    if (auto signature = position->getTimeSignature();
+        signature.hasValue() && signature->numerator > 0 && signature->denominator > 0)
+    {
+        transport.quarterNotesPerBar = 4.0 * signature->numerator / signature->denominator;
+        hostTimeSignature.store(signature->numerator << 8 | signature->denominator,
+                                std::memory_order_relaxed);
+    }
+    if (auto ppq = position->getPpqPosition())
+    {
+        transport.isPlaying = position->getIsPlaying();
+        transport.ppqPosition = *ppq;
+    }
+    return transport;
+}
+
+PerformanceEngine::Settings ChordPumperProcessor::readPerformanceSettings() const
+{
+    PerformanceEngine::Settings settings;
+    settings.mode = static_cast<PerformanceEngine::Mode>(static_cast<int>(playMode->load()));
+    settings.strumAmount = strumAmount->load();
+    settings.strumUnit = static_cast<PerformanceEngine::StrumUnit>(static_cast<int>(strumUnit->load()));
+    settings.strumDirection = static_cast<PerformanceEngine::StrumDirection>(static_cast<int>(strumDirection->load()));
+    settings.arpPattern = static_cast<PerformanceEngine::ArpPattern>(static_cast<int>(arpPattern->load()));
+    const int rate = juce::jlimit(0, static_cast<int>(std::size(kArpRates)) - 1, static_cast<int>(arpRate->load()));
+    settings.arpStepBeats = kArpRates[rate];
+    settings.arpGate = arpGate->load();
+    settings.ratchets = static_cast<int>(ratchets->load());
+    return settings;
+}
+
+StripSequencer::Transport ChordPumperProcessor::readTransport(const clap_event_transport_t* clapTransport)
+{
+    StripSequencer::Transport transport;
+    if (clapTransport == nullptr)
+        return transport;
+
+    if ((clapTransport->flags & CLAP_TRANSPORT_HAS_TEMPO) != 0 && clapTransport->tempo > 0.0)
+    {
+        transport.bpm = clapTransport->tempo;
+        hostBpm.store(clapTransport->tempo, std::memory_order_relaxed);
+    }
+    if ((clapTransport->flags & CLAP_TRANSPORT_HAS_TIME_SIGNATURE) != 0
+        && clapTransport->tsig_num > 0 && clapTransport->tsig_denom > 0)
+    {
+        transport.quarterNotesPerBar = 4.0 * clapTransport->tsig_num / clapTransport->tsig_denom;
+        hostTimeSignature.store(clapTransport->tsig_num << 8 | clapTransport->tsig_denom,
+                                std::memory_order_relaxed);
+    }
+    if ((clapTransport->flags & CLAP_TRANSPORT_HAS_BEATS_TIMELINE) != 0)
+    {
+        transport.isPlaying = (clapTransport->flags & CLAP_TRANSPORT_IS_PLAYING) != 0;
+        transport.ppqPosition = static_cast<double>(clapTransport->song_pos_beats) / CLAP_BEATTIME_FACTOR;
+    }
+    return transport;
+}
+
+MorphWeights ChordPumperProcessor::getMorphWeights() const
+{
+    MorphWeights weights;
+    weights.diatonic = diatonicWeight->load(std::memory_order_relaxed);
+    weights.commonTones = commonToneWeight->load(std::memory_order_relaxed);
+    weights.voiceLeading = voiceLeadingWeight->load(std::memory_order_relaxed);
+    return weights;
+}
+
+MidiFileBuilder::ExportOptions ChordPumperProcessor::getExportOptions() const
+{
+    MidiFileBuilder::ExportOptions options;
+    options.bpm = hostBpm.load(std::memory_order_relaxed);
+    const int signature = hostTimeSignature.load(std::memory_order_relaxed);
+    options.timeSigNumerator = signature >> 8;
+    options.timeSigDenominator = signature & 0xff;
+    return options;
 }
 
 juce::AudioProcessorEditor* ChordPumperProcessor::createEditor()
@@ -33,31 +570,98 @@ juce::AudioProcessorEditor* ChordPumperProcessor::createEditor()
 
 void ChordPumperProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::ValueTree state;
+    CHORDPUMPER_TRACE_SCOPE("getStateInformation");
+    // Moves CLAP automation into the parameter tree before it is copied
+    flushClapParameterChanges();
+    const juce::ScopedLock savedLock(savedStateLock);
+    bool changed = false;
     {
         const juce::ScopedLock sl(stateLock);
-        state = persistentState.toValueTree();
+        // Keeps the Weights node readable by versions without the parameters
+        if (const auto weights = getMorphWeights(); weights != persistentState.weights)
+        {
+            persistentState.weights = weights;
+            persistentState.markDirty(PersistentState::kWeightsSection);
+        }
+        changed = persistentState.updateValueTree(savedState);
+    }
+
+    const auto parametersType = parameters.state.getType();
+    if (parametersChangedSinceSave() || !savedState.getChildWithName(parametersType).isValid())
+    {
+        savedState.removeChild(savedState.getChildWithName(parametersType), nullptr);
+        savedState.appendChild(parameters.copyState(), nullptr);
+        changed = true;
+    }
+
+    if (changed || savedBlob.isEmpty())
+    {
+        CHORDPUMPER_TRACE_SCOPE("getStateInformation::encode");
+        if (auto xml = savedState.createXml())
+            copyXmlToBinary(*xml, savedBlob);
+    }
+    destData = savedBlob;
+}
+
+// Compares every parameter with its value at the last save and records the
+// current values. A handful of float reads, so a clean save stays cheap.
+bool ChordPumperProcessor::parametersChangedSinceSave()
+{
+    const auto& params = getParameters();
+    bool changed = savedParameterValues.size() != static_cast<size_t>(params.size());
+    savedParameterValues.resize(static_cast<size_t>(params.size()));
+    for (int i = 0; i < params.size(); ++i)
+    {
+        const float value = params[i]->getValue();
+        auto& saved = savedParameterValues[static_cast<size_t>(i)];
+        changed = changed || value != saved;
+        saved = value;
     }
-    if (auto xml = state.createXml())
-        copyXmlToBinary(*xml, destData);
+    return changed;
 }
 
 void ChordPumperProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+    CHORDPUMPER_TRACE_SCOPE("setStateInformation");
     auto xml = getXmlFromBinary(data, sizeInBytes);
     if (xml == nullptr) return;
 
     auto tree = juce::ValueTree::fromXml(*xml);
     if (!tree.isValid()) return;
 
+    auto saved = tree.getChildWithName(parameters.state.getType());
+    if (saved.isValid())
+        parameters.replaceState(saved);
+
     auto restored = PersistentState::fromValueTree(tree);
+
+    // Sessions saved before the weights became parameters only have the Weights node
+    if (!saved.getChildWithProperty("id", "diatonicWeight").isValid())
+    {
+        auto setWeight = [this](const char* id, float value) {
+            if (auto* parameter = parameters.getParameter(id))
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        };
+        setWeight("diatonicWeight", restored.weights.diatonic);
+        setWeight("commonToneWeight", restored.weights.commonTones);
+        setWeight("voiceLeadingWeight", restored.weights.voiceLeading);
+    }
     {
         const juce::ScopedLock sl(stateLock);
         persistentState = std::move(restored);
     }
+    publishSequence();
     sendChangeMessage();
 }
 
+void ChordPumperProcessor::publishSequence()
+{
+    // stateLock also serialises writers, which the sequencer requires
+    const juce::ScopedLock sl(stateLock);
+    sequencer.publish(SequenceSnapshot::fromProgression(persistentState.progression,
+                                                        persistentState.syncToHost));
+}
+
 } // namespace chordpumper
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
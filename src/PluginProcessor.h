@@ -1,22 +1,48 @@
 #pragma once
 
 #include "PersistentState.h"
+#include "diagnostics/PerfCounters.h"
+#include "engine/ChordRecognizer.h"
+#include "engine/EngineTables.h"
+#include "engine/KeyDetector.h"
+#include "dsp/ChromagramAnalyzer.h"
+#include "midi/ClapNoteBridge.h"
+#include "midi/HarmonyLink.h"
+#include "midi/MidiFileBuilder.h"
+#include "midi/MpeOutput.h"
+#include "midi/PerformanceEngine.h"
+#include "midi/PerformanceRecorder.h"
+#include "midi/PreviewNoteQueue.h"
+#include "midi/StripSequencer.h"
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <clap-juce-extensions/clap-juce-extensions.h>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 namespace chordpumper {
 
 class ChordPumperProcessor : public juce::AudioProcessor,
-                              public juce::ChangeBroadcaster
+                              public juce::ChangeBroadcaster,
+                              public clap_juce_extensions::clap_juce_audio_processor_capabilities
 {
 public:
     ChordPumperProcessor();
-    ~ChordPumperProcessor() override = default;
+    ~ChordPumperProcessor() override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override;
     using AudioProcessor::processBlock;
 
+    // CLAP: bypasses processBlock and exchanges native note events, with
+    // note IDs and per-note expression on the output.
+    bool supportsDirectProcess() override { return true; }
+    clap_process_status clap_direct_process(const clap_process* process) noexcept override;
+    bool supportsNoteDialectClap(bool) override { return true; }
+    bool prefersNoteDialectClap(bool) override { return true; }
+
     bool hasEditor() const override { return true; }
     juce::AudioProcessorEditor* createEditor() override;
 
@@ -35,16 +61,131 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    juce::MidiKeyboardState& getKeyboardState() { return keyboardState; }
+    PreviewNoteQueue& getPreviewQueue() { return previewQueue; }
+    PerformanceRecorder& getRecorder() { return recorder; }
 
     PersistentState& getState() { return persistentState; }
     const PersistentState& getState() const { return persistentState; }
     juce::CriticalSection& getStateLock() { return stateLock; }
 
+    PerfCounters& getPerfCounters() { return perfCounters; }
+
+    // Host-automatable parameters (morph weights and complexity, the
+    // performance stage's play mode, strum and arpeggio settings, MPE output
+    // and the harmony link).
+    juce::AudioProcessorValueTreeState& getParameters() { return parameters; }
+
+    // Lock-free reads of the grid parameters, for the editor's timer.
+    MorphWeights getMorphWeights() const;
+    float getComplexity() const { return complexity->load(std::memory_order_relaxed); }
+
+    // Hands the current progression and sync setting to the audio thread.
+    // Call after changing either; message thread only.
+    void publishSequence();
+
+    // Export settings following the host's last reported tempo and meter
+    // (120 BPM 4/4 until the host reports one).
+    MidiFileBuilder::ExportOptions getExportOptions() const;
+
+    // Latest chord recognised from incoming MIDI, packed with a counter that
+    // changes on every new recognition (see unpackRecognizedChord).
+    uint32_t getRecognizedChord() const { return recognizedChord.load(std::memory_order_acquire); }
+
+    // Latest key estimate from incoming MIDI, packed (see unpackKeyEstimate).
+    // A harmony link follower reports its leader's key instead.
+    uint32_t getDetectedKey() const { return detectedKey.load(std::memory_order_acquire); }
+
+    // Latest chord from the harmony link leader when following in Morph
+    // mode, packed like getRecognizedChord.
+    uint32_t getLinkedChord() const { return linkedChord.load(std::memory_order_acquire); }
+
+    // Tells parameter listeners (the editor and the saved parameter tree)
+    // about values CLAP events set on the audio thread. Not the audio thread.
+    void flushClapParameterChanges();
+
 private:
-    juce::MidiKeyboardState keyboardState;
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    StripSequencer::Transport readTransport();
+    StripSequencer::Transport readTransport(const clap_event_transport_t* clapTransport);
+    PerformanceEngine::Settings readPerformanceSettings() const;
+    void applyClapParameter(const clap_event_param_value_t& event);
+
+    // Shared by processBlock and clap_direct_process
+    void beginBlock(const StripSequencer::Transport& transport, int numSamples);
+    void analyseSidechain(const float* const* channels, int numChannels, int numSamples);
+    void handleInputMessage(const juce::MidiMessage& message, int samplePosition);
+    void renderBlock(const StripSequencer::Transport& transport, int numSamples, juce::MidiBuffer& output);
+    void updateHarmonyLink();
+    void releaseLinkNotes();
+    void measureLoad(std::chrono::steady_clock::time_point blockStart, int numSamples);
+    bool parametersChangedSinceSave();
+
+    PreviewNoteQueue previewQueue;
     PersistentState persistentState;
     juce::CriticalSection stateLock;
+    // The last saved state, handed out again while nothing has changed
+    juce::CriticalSection savedStateLock;  // taken before stateLock
+    juce::ValueTree savedState;  // the persistent state's sections, then the parameters
+    juce::MemoryBlock savedBlob;
+    std::vector<float> savedParameterValues;
+    PerfCounters perfCounters;
+    ChordRecognizer chordRecognizer;  // audio thread only
+    std::atomic<uint32_t> recognizedChord{packRecognizedChord({}, 0)};
+    uint8_t recognitionSerial = 0;
+    bool inputNoteAdded = false;
+    ChromagramAnalyzer chromagram;  // audio thread only
+    ChordId lastSidechainChord = kNoChord;
+    KeyDetector keyDetector;  // audio thread only
+    std::atomic<uint32_t> detectedKey{packKeyEstimate({}, 0)};
+    uint8_t keySerial = 0;
+    StripSequencer sequencer;
+    PerformanceRecorder recorder;
+    PerformanceEngine performance;
+    juce::MidiBuffer performanceInput;  // pad, strip and sequencer notes, audio thread only
+    juce::MidiBuffer performanceOutput;  // audio thread only
+    juce::MidiBuffer expressionInput;  // host pitch bend, pressure and CC74, audio thread only
+    MpeOutput mpeOutput;
+    ClapNoteBridge clapNotes;  // audio thread only
+    juce::MidiBuffer clapOutput;  // audio thread only
+    juce::MidiBuffer hostOutput;  // swapped into the host's buffer, audio thread only
+    const juce::uint8* hostOutputStorage = nullptr;  // storage last handed to the host, audio thread only
+    std::thread::id tracedAudioThread;  // last thread named "Audio" in traces, audio thread only
+    // Keeps the process-wide tables alive while the editor is closed
+    std::shared_ptr<const EngineTables> engineTables = EngineTables::shared();
+    HarmonyLink& harmonyLink = HarmonyLink::shared();
+    const uint32_t linkInstanceId = harmonyLink.newInstanceId();
+    int linkLeadGroup = -1;  // group this instance leads, audio thread only
+    uint32_t linkVersion = 0;
+    bool linkPublishPending = false;
+    std::array<uint64_t, 2> heldNotes{};  // what this instance plays, as a bitset
+    std::array<uint8_t, HarmonyLink::kMaxNotes> linkNotes{};  // followed notes sounding
+    int numLinkNotes = 0;
+    std::atomic<uint32_t> linkedChord{packRecognizedChord({}, 0)};
+    uint8_t linkSerial = 0;
+    juce::AudioProcessorValueTreeState parameters;
+    std::atomic<float>* diatonicWeight = nullptr;
+    std::atomic<float>* commonToneWeight = nullptr;
+    std::atomic<float>* voiceLeadingWeight = nullptr;
+    std::atomic<float>* complexity = nullptr;
+    std::atomic<float>* playMode = nullptr;
+    std::atomic<float>* strumAmount = nullptr;
+    std::atomic<float>* strumUnit = nullptr;
+    std::atomic<float>* strumDirection = nullptr;
+    std::atomic<float>* arpPattern = nullptr;
+    std::atomic<float>* arpRate = nullptr;
+    std::atomic<float>* arpGate = nullptr;
+    std::atomic<float>* ratchets = nullptr;
+    std::atomic<float>* mpeEnabled = nullptr;
+    std::atomic<float>* mpeChannelReuse = nullptr;
+    std::atomic<float>* linkGroup = nullptr;
+    std::atomic<float>* linkRole = nullptr;
+    std::atomic<float>* linkFollowMode = nullptr;
+    std::atomic<float>* linkOctave = nullptr;
+    std::vector<std::atomic<float>*> rawParameterValues;  // by parameter index
+    std::atomic<uint64_t> pendingParameterChanges{0};  // bit per parameter index, set by CLAP events
+    std::atomic<double> hostBpm{120.0};
+    std::atomic<int> hostTimeSignature{4 << 8 | 4};  // numerator << 8 | denominator
+    double currentSampleRate = 44100.0;
 };
 
 } // namespace chordpumper
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Rolling last/average/max of one measurement, updated lock-free on the hot
+// path and read by the performance overlay. Each stat has exactly one writer
+// thread; readers may run concurrently and see each field independently.
+class PerfStat {
+public:
+    struct Snapshot {
+        float last;
+        float average;
+        float max;
+        uint32_t count;
+    };
+
+    // Weight of the newest sample in the exponential moving average.
+    static constexpr float kSmoothing = 0.05f;
+
+    void add(float value) noexcept {
+        uint32_t n = count.load(std::memory_order_relaxed);
+        float avg = average.load(std::memory_order_relaxed);
+        float peak = max.load(std::memory_order_relaxed);
+
+        if (resetRequested.exchange(false, std::memory_order_acquire)) {
+            n = 0;
+            peak = 0.0f;
+        }
+
+        avg = n == 0 ? value : avg + kSmoothing * (value - avg);
+        if (value > peak)
+            peak = value;
+
+        last.store(value, std::memory_order_relaxed);
+        average.store(avg, std::memory_order_relaxed);
+        max.store(peak, std::memory_order_relaxed);
+        count.store(n + 1, std::memory_order_release);
+    }
+
+    Snapshot read() const noexcept {
+        uint32_t n = count.load(std::memory_order_acquire);
+        return {last.load(std::memory_order_relaxed), average.load(std::memory_order_relaxed),
+                max.load(std::memory_order_relaxed), n};
+    }
+
+    // Any thread: the writer restarts the statistics on its next sample.
+    void reset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    // Adds the elapsed wall time of its scope, in milliseconds.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(PerfStat& target) noexcept
+            : stat(target), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            stat.add(elapsed.count());
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        PerfStat& stat;
+        std::chrono::steady_clock::time_point start;
+    };
+
+private:
+    std::atomic<float> last{0.0f};
+    std::atomic<float> average{0.0f};
+    std::atomic<float> max{0.0f};
+    std::atomic<uint32_t> count{0};
+    std::atomic<bool> resetRequested{false};
+};
+
+// Counters behind the editor's performance overlay. Owned by the processor so
+// they outlive editor instances.
+struct PerfCounters {
+    PerfStat morph;        // ms, MorphEngine::morph (message thread)
+    PerfStat voicing;      // ms, optimalVoicing (message thread)
+    PerfStat gridRepaint;  // ms, GridPanel paint including its pads (message thread)
+    PerfStat editorOpen;   // ms, ChordPumperEditor construction (message thread)
+    PerfStat audioLoad;    // processBlock duration / buffer period (audio thread)
+
+    void reset() noexcept {
+        morph.reset();
+        voicing.reset();
+        gridRepaint.reset();
+        editorOpen.reset();
+        audioLoad.reset();
+    }
+};
+
+} // namespace chordpumper
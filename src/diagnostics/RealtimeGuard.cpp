@@ -0,0 +1,117 @@
+#include "diagnostics/RealtimeGuard.h"
+#include <atomic>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <execinfo.h>
+
+namespace chordpumper {
+
+namespace {
+
+thread_local int sectionDepth = 0;
+thread_local bool isRecording = false;
+
+std::atomic<int> violationCount{0};
+RealtimeGuard::Record records[RealtimeGuard::kMaxRecords];
+
+const char* violationName(RealtimeGuard::Violation kind) {
+    switch (kind) {
+        case RealtimeGuard::Violation::Allocation:    return "allocation";
+        case RealtimeGuard::Violation::Deallocation:  return "deallocation";
+        case RealtimeGuard::Violation::Lock:          return "lock";
+        case RealtimeGuard::Violation::ContendedLock: return "contended lock";
+    }
+    return "unknown";
+}
+
+// backtrace_symbols() yields "binary(mangled+0xoff) [addr]"; demangle the middle part.
+std::string demangleFrame(const char* symbol) {
+    std::string line(symbol);
+    auto open = line.find('(');
+    auto plus = line.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+        return line;
+
+    std::string mangled = line.substr(open + 1, plus - open - 1);
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    if (status != 0 || demangled == nullptr)
+        return line;
+
+    std::string result = demangled;
+    std::free(demangled);
+    return result;
+}
+
+} // anonymous namespace
+
+void RealtimeGuard::enter() noexcept {
+    ++sectionDepth;
+}
+
+void RealtimeGuard::exit() noexcept {
+    --sectionDepth;
+}
+
+bool RealtimeGuard::isInSection() noexcept {
+    return sectionDepth > 0 && !isRecording;
+}
+
+void RealtimeGuard::report(Violation kind, std::size_t bytes) noexcept {
+    if (!isInSection())
+        return;
+
+    isRecording = true;
+    int index = violationCount.fetch_add(1, std::memory_order_relaxed);
+    if (index < kMaxRecords) {
+        auto& record = records[index];
+        record.kind = kind;
+        record.bytes = bytes;
+        record.numFrames = backtrace(record.frames, kMaxFrames);
+    }
+    isRecording = false;
+}
+
+int RealtimeGuard::getNumViolations() noexcept {
+    return violationCount.load(std::memory_order_relaxed);
+}
+
+RealtimeGuard::Record RealtimeGuard::getRecord(int index) noexcept {
+    return records[index];
+}
+
+void RealtimeGuard::reset() noexcept {
+    violationCount.store(0, std::memory_order_relaxed);
+}
+
+std::string RealtimeGuard::describe() {
+    std::string out;
+    int total = getNumViolations();
+    int shown = total < kMaxRecords ? total : kMaxRecords;
+
+    for (int i = 0; i < shown; ++i) {
+        const auto& record = records[i];
+        out += "#" + std::to_string(i) + " " + violationName(record.kind);
+        if (record.bytes > 0)
+            out += " (" + std::to_string(record.bytes) + " bytes)";
+        out += "\n";
+
+        char** symbols = backtrace_symbols(record.frames, record.numFrames);
+        // Skip report() and the hook that called it
+        for (int f = 2; symbols != nullptr && f < record.numFrames; ++f)
+            out += "    " + demangleFrame(symbols[f]) + "\n";
+        std::free(symbols);
+    }
+
+    if (total > shown)
+        out += std::to_string(total - shown) + " more violation(s) without stacks\n";
+
+    return out;
+}
+
+void RealtimeGuard::warmUp() noexcept {
+    void* frames[2];
+    backtrace(frames, 2);
+}
+
+} // namespace chordpumper
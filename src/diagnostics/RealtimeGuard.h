@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef CHORDPUMPER_REALTIME_CHECKS
+#define CHORDPUMPER_REALTIME_CHECKS 0
+#endif
+
+namespace chordpumper {
+
+// Records real-time-safety violations (heap traffic, mutex acquisition) made
+// by a thread while it is inside a ScopedSection. The section itself is a
+// thread-local counter; detection comes from RealtimeHooks.cpp, which is only
+// linked into the render harness and the unit tests.
+class RealtimeGuard {
+public:
+    enum class Violation : uint8_t { Allocation, Deallocation, Lock, ContendedLock };
+
+    static constexpr int kMaxRecords = 64;
+    static constexpr int kMaxFrames = 24;
+
+    struct Record {
+        Violation kind;
+        std::size_t bytes;
+        int numFrames;
+        void* frames[kMaxFrames];
+    };
+
+    class ScopedSection {
+    public:
+#if CHORDPUMPER_REALTIME_CHECKS
+        ScopedSection() noexcept { enter(); }
+        ~ScopedSection() { exit(); }
+#else
+        ScopedSection() noexcept {}
+#endif
+        ScopedSection(const ScopedSection&) = delete;
+        ScopedSection& operator=(const ScopedSection&) = delete;
+    };
+
+    static bool isInSection() noexcept;
+    static void report(Violation kind, std::size_t bytes = 0) noexcept;
+
+    // Total violations since the last reset; only the first kMaxRecords keep a stack.
+    static int getNumViolations() noexcept;
+    static Record getRecord(int index) noexcept;
+    static void reset() noexcept;
+
+    // Human-readable report with symbolised stacks. Allocates; never call it
+    // from inside a section.
+    static std::string describe();
+
+    // Resolves the unwinder up front so the first recorded stack does not
+    // allocate while a violation is being reported.
+    static void warmUp() noexcept;
+
+private:
+    static void enter() noexcept;
+    static void exit() noexcept;
+};
+
+} // namespace chordpumper
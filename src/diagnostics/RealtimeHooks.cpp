@@ -0,0 +1,83 @@
+// Global allocation and mutex interposers feeding RealtimeGuard.
+//
+// Link this file only into test/diagnostic executables, together with
+// -Wl,--wrap=pthread_mutex_lock. It must never be part of the plugin.
+
+#include "diagnostics/RealtimeGuard.h"
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#include <pthread.h>
+
+using chordpumper::RealtimeGuard;
+
+namespace {
+
+void* allocate(std::size_t size) {
+    RealtimeGuard::report(RealtimeGuard::Violation::Allocation, size);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t align) {
+    RealtimeGuard::report(RealtimeGuard::Violation::Allocation, size);
+    auto alignment = static_cast<std::size_t>(align);
+    std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+    if (void* p = std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded))
+        return p;
+    throw std::bad_alloc();
+}
+
+void release(void* p) noexcept {
+    if (p == nullptr)
+        return;
+    RealtimeGuard::report(RealtimeGuard::Violation::Deallocation);
+    std::free(p);
+}
+
+} // anonymous namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+
+extern "C" {
+
+int __real_pthread_mutex_lock(pthread_mutex_t* mutex);
+
+int __wrap_pthread_mutex_lock(pthread_mutex_t* mutex) {
+    if (!RealtimeGuard::isInSection())
+        return __real_pthread_mutex_lock(mutex);
+
+    int result = pthread_mutex_trylock(mutex);
+    if (result == 0) {
+        RealtimeGuard::report(RealtimeGuard::Violation::Lock);
+        return 0;
+    }
+
+    RealtimeGuard::report(result == EBUSY ? RealtimeGuard::Violation::ContendedLock
+                                          : RealtimeGuard::Violation::Lock);
+    return __real_pthread_mutex_lock(mutex);
+}
+
+} // extern "C"
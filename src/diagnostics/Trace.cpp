@@ -0,0 +1,193 @@
+#include "diagnostics/Trace.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace chordpumper {
+
+std::atomic<bool> Trace::enabled{false};
+
+namespace {
+
+static_assert((Trace::kEventsPerThread & (Trace::kEventsPerThread - 1)) == 0,
+              "ring size must be a power of two");
+static_assert(std::atomic<std::thread::id>::is_always_lock_free,
+              "finding a thread's buffer must not take a lock");
+
+struct Event {
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+// The export reads slots the owning thread may be overwriting, so the fields
+// are atomics and a torn copy is detected and dropped rather than racing.
+struct EventSlot {
+    std::atomic<const char*> name;
+    std::atomic<int64_t> startNs;
+    std::atomic<int64_t> durationNs;
+};
+
+struct ThreadBuffer {
+    std::atomic<std::thread::id> owner{};  // default id while the buffer is free
+    std::atomic<uint32_t> generation{0};  // bumped each time a thread claims the buffer
+    std::atomic<uint64_t> written{0};
+    std::atomic<const char*> threadName{nullptr};
+    std::array<EventSlot, Trace::kEventsPerThread> events;
+};
+
+// Zero-initialised storage; pages are only touched by threads that trace.
+std::array<ThreadBuffer, Trace::kMaxThreads> buffers;
+std::atomic<int> usedBuffers{0};  // one past the highest buffer ever claimed
+
+// Initialised at load time so now() never hits a static-init guard on the audio thread
+const auto processEpoch = std::chrono::steady_clock::now();
+
+// Buffers are found by owner rather than through a thread_local: setting up
+// thread-local storage, or registering a destructor for it, can allocate on
+// the thread's first traced event, which may be on the audio thread.
+ThreadBuffer* ownedBuffer(std::thread::id self) noexcept {
+    int used = usedBuffers.load(std::memory_order_acquire);
+    for (int index = 0; index < used; ++index) {
+        auto& buffer = buffers[static_cast<size_t>(index)];
+        if (buffer.owner.load(std::memory_order_relaxed) == self)
+            return &buffer;
+    }
+    return nullptr;
+}
+
+ThreadBuffer* bufferForThisThread() noexcept {
+    const auto self = std::this_thread::get_id();
+    if (auto* buffer = ownedBuffer(self))
+        return buffer;
+
+    for (int index = 0; index < Trace::kMaxThreads; ++index) {
+        auto& buffer = buffers[static_cast<size_t>(index)];
+        std::thread::id expected;
+        if (!buffer.owner.compare_exchange_strong(expected, self, std::memory_order_acquire))
+            continue;
+
+        buffer.generation.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffer.written.store(0, std::memory_order_relaxed);
+        buffer.threadName.store(nullptr, std::memory_order_relaxed);
+
+        int used = usedBuffers.load(std::memory_order_relaxed);
+        while (used <= index && !usedBuffers.compare_exchange_weak(used, index + 1, std::memory_order_release)) {
+        }
+
+        return &buffer;
+    }
+    return nullptr;
+}
+
+void writeEscaped(std::ostream& out, const char* text) {
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\')
+            out << '\\';
+        out << *c;
+    }
+}
+
+} // anonymous namespace
+
+int64_t Trace::now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - processEpoch).count();
+}
+
+void Trace::setThreadName(const char* name) noexcept {
+    if (auto* buffer = bufferForThisThread())
+        buffer->threadName.store(name, std::memory_order_relaxed);
+}
+
+void Trace::releaseThread() noexcept {
+    if (auto* buffer = ownedBuffer(std::this_thread::get_id()))
+        buffer->owner.store(std::thread::id{}, std::memory_order_release);
+}
+
+void Trace::record(const char* name, int64_t startNs, int64_t endNs) noexcept {
+    auto* buffer = bufferForThisThread();
+    if (buffer == nullptr)
+        return;
+
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    auto& slot = buffer->events[index & (kEventsPerThread - 1)];
+
+    // A reader that sees any of these stores also sees written >= index, which
+    // is how it knows the slot may be mid-overwrite.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Trace::writeChromeJson(std::ostream& out) {
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char number[32];
+
+    int numBuffers = usedBuffers.load(std::memory_order_acquire);
+    std::vector<Event> snapshot;
+    snapshot.reserve(kEventsPerThread);
+
+    for (int t = 0; t < numBuffers; ++t) {
+        auto& buffer = buffers[static_cast<size_t>(t)];
+
+        uint32_t generation = buffer.generation.load(std::memory_order_acquire);
+        uint64_t end = buffer.written.load(std::memory_order_acquire);
+        uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+        snapshot.clear();
+        for (uint64_t i = begin; i < end; ++i) {
+            const auto& slot = buffer.events[i & (kEventsPerThread - 1)];
+            snapshot.push_back({slot.name.load(std::memory_order_relaxed),
+                                slot.startNs.load(std::memory_order_relaxed),
+                                slot.durationNs.load(std::memory_order_relaxed)});
+        }
+
+        // Discard entries the owning thread may have overwritten while we
+        // copied, counting the write it may have started but not published,
+        // and everything if another thread claimed the buffer meanwhile.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = buffer.written.load(std::memory_order_relaxed);
+        size_t skip = 0;
+        if (buffer.generation.load(std::memory_order_relaxed) != generation || after < end)
+            skip = snapshot.size();
+        else if (after + 1 > kEventsPerThread && after + 1 - kEventsPerThread > begin)
+            skip = static_cast<size_t>(std::min<uint64_t>(after + 1 - kEventsPerThread - begin, snapshot.size()));
+
+        if (!first) out << ',';
+        first = false;
+        const char* threadName = buffer.threadName.load(std::memory_order_relaxed);
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":\"";
+        if (threadName != nullptr)
+            writeEscaped(out, threadName);
+        else
+            out << "Thread " << t;
+        out << "\"}}";
+
+        for (size_t i = skip; i < snapshot.size(); ++i) {
+            const auto& ev = snapshot[i];
+            out << ",{\"name\":\"";
+            writeEscaped(out, ev.name);
+            std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(ev.startNs) / 1000.0);
+            out << "\",\"cat\":\"chordpumper\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t << ",\"ts\":" << number;
+            std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(ev.durationNs) / 1000.0);
+            out << ",\"dur\":" << number << '}';
+        }
+    }
+
+    out << "]}\n";
+}
+
+void Trace::clear() noexcept {
+    for (auto& buffer : buffers)
+        buffer.written.store(0, std::memory_order_relaxed);
+}
+
+} // namespace chordpumper
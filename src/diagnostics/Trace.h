@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#ifndef CHORDPUMPER_TRACING
+#define CHORDPUMPER_TRACING 1
+#endif
+
+namespace chordpumper {
+
+// Scoped duration tracing into per-thread lock-free ring buffers, exported as
+// Chrome trace JSON (open in Perfetto or chrome://tracing).
+//
+// Recording is off until setEnabled(true); a disabled scope costs one relaxed
+// atomic load. Each thread claims a preallocated buffer on its first event, so
+// tracing never allocates, including on the audio thread. Names must be string
+// literals: only the pointer is stored.
+class Trace {
+public:
+    static constexpr int kMaxThreads = 16;  // threads tracing at the same time
+    static constexpr int kEventsPerThread = 4096;
+
+    static void setEnabled(bool shouldRecord) noexcept {
+        enabled.store(shouldRecord, std::memory_order_relaxed);
+    }
+    static bool isEnabled() noexcept {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // Label shown for the calling thread in the trace viewer.
+    static void setThreadName(const char* name) noexcept;
+
+    // Hands the calling thread's buffer to later threads; call it before a
+    // thread that traced exits. Its events stay exportable until the buffer is
+    // reused. Long-lived threads such as the audio thread keep theirs.
+    static void releaseThread() noexcept;
+
+    static int64_t now() noexcept;
+    static void record(const char* name, int64_t startNs, int64_t endNs) noexcept;
+
+    // Writes every buffered event; safe to call while other threads record.
+    static void writeChromeJson(std::ostream& out);
+
+    // Drops buffered events. Not synchronised with writers.
+    static void clear() noexcept;
+
+    class Scope {
+    public:
+        explicit Scope(const char* scopeName) noexcept
+            : name(scopeName), start(isEnabled() ? now() : -1) {}
+        ~Scope() {
+            if (start >= 0)
+                record(name, start, now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        int64_t start;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+} // namespace chordpumper
+
+#define CHORDPUMPER_TRACE_CONCAT_(a, b) a##b
+#define CHORDPUMPER_TRACE_CONCAT(a, b) CHORDPUMPER_TRACE_CONCAT_(a, b)
+
+#if CHORDPUMPER_TRACING
+#define CHORDPUMPER_TRACE_SCOPE(name) \
+    const ::chordpumper::Trace::Scope CHORDPUMPER_TRACE_CONCAT(chordpumperTrace_, __LINE__){name}
+#else
+#define CHORDPUMPER_TRACE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,191 @@
+#include "dsp/ChromagramAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace chordpumper {
+
+namespace {
+
+double noteFrequency(double midiNote) {
+    return 440.0 * std::exp2((midiNote - 69.0) / 12.0);
+}
+
+} // anonymous namespace
+
+void ChromagramAnalyzer::prepare(double sampleRate, int /*maxBlockSize*/) {
+    decimation = std::max(1, static_cast<int>(std::lround(sampleRate / kTargetAnalysisRate)));
+    analysisRate = sampleRate / decimation;
+
+    fft = std::make_unique<juce::dsp::FFT>(kFftOrder);
+    window.assign(static_cast<size_t>(kFftSize), 0.0f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(
+        window.data(), static_cast<size_t>(kFftSize),
+        juce::dsp::WindowingFunction<float>::hann, false);
+    history.assign(static_cast<size_t>(kFftSize), 0.0f);
+    fftData.assign(static_cast<size_t>(2 * kFftSize), 0.0f);
+
+    // Fourth-order low-pass just below the decimated Nyquist frequency
+    const double cutoff = 0.45 * analysisRate;
+    auto stage1 = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, cutoff, 0.5412);
+    auto stage2 = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, cutoff, 1.3066);
+    antiAlias[0].coefficients = stage1;
+    antiAlias[1].coefficients = stage2;
+
+    const double binHz = analysisRate / kFftSize;
+    const int numBands = kHighestNote - kLowestNote + 1;
+    bandStart.assign(static_cast<size_t>(numBands), 0);
+    bandEnd.assign(static_cast<size_t>(numBands), 0);
+    for (int band = 0; band < numBands; ++band) {
+        double note = kLowestNote + band;
+        int start = static_cast<int>(std::ceil(noteFrequency(note - 0.5) / binHz));
+        int end = static_cast<int>(std::ceil(noteFrequency(note + 0.5) / binHz));
+        if (end <= start) {
+            // Band narrower than a bin at low frequencies: use the nearest bin
+            start = static_cast<int>(std::lround(noteFrequency(note) / binHz));
+            end = start + 1;
+        }
+        bandStart[static_cast<size_t>(band)] = std::clamp(start, 1, kFftSize / 2);
+        bandEnd[static_cast<size_t>(band)] = std::clamp(end, 1, kFftSize / 2);
+    }
+
+    reset();
+}
+
+void ChromagramAnalyzer::reset() {
+    std::fill(history.begin(), history.end(), 0.0f);
+    for (auto& filter : antiAlias)
+        filter.reset();
+    smoothedChroma.fill(0.0f);
+    candidateTones = 0;
+    candidateBass = -1;
+    candidateFrames = 0;
+    stableTones = 0;
+    stableBass = -1;
+    decimationPhase = 0;
+    writePosition = 0;
+    samplesSinceFrame = 0;
+}
+
+bool ChromagramAnalyzer::process(const float* const* channels, int numChannels, int numSamples) {
+    if (fft == nullptr || numChannels <= 0)
+        return false;
+
+    const float gain = 1.0f / static_cast<float>(numChannels);
+    bool analysed = false;
+
+    for (int i = 0; i < numSamples; ++i) {
+        float mono = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+            mono += channels[ch][i];
+
+        float filtered = antiAlias[1].processSample(antiAlias[0].processSample(mono * gain));
+        if (++decimationPhase < decimation)
+            continue;
+        decimationPhase = 0;
+
+        history[static_cast<size_t>(writePosition)] = filtered;
+        writePosition = (writePosition + 1) & (kFftSize - 1);
+
+        if (++samplesSinceFrame >= kHopSize) {
+            samplesSinceFrame = 0;
+            analyseFrame();
+            analysed = true;
+        }
+    }
+    return analysed;
+}
+
+void ChromagramAnalyzer::analyseFrame() {
+    // Unroll the circular history (oldest first) and apply the window
+    const int tail = kFftSize - writePosition;
+    std::copy_n(history.data() + writePosition, tail, fftData.data());
+    std::copy_n(history.data(), writePosition, fftData.data() + tail);
+
+    float energy = 0.0f;
+    for (int i = 0; i < kFftSize; ++i)
+        energy += fftData[static_cast<size_t>(i)] * fftData[static_cast<size_t>(i)];
+    const float rms = std::sqrt(energy / kFftSize);
+    if (rms < kSilenceRms) {
+        settle(0, -1);
+        return;
+    }
+
+    juce::FloatVectorOperations::multiply(fftData.data(), window.data(), kFftSize);
+    fft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    std::array<float, 12> frame{};
+    std::array<float, kBassNotes> bassEnergy{};
+    const int numBands = static_cast<int>(bandStart.size());
+    for (int band = 0; band < numBands; ++band) {
+        const auto b = static_cast<size_t>(band);
+        float bandEnergy = 0.0f;
+        for (int bin = bandStart[b]; bin < bandEnd[b]; ++bin)
+            bandEnergy += fftData[static_cast<size_t>(bin)];
+
+        const int note = kLowestNote + band;
+        frame[static_cast<size_t>(note % 12)] += bandEnergy;
+        if (band < kBassNotes)
+            bassEnergy[b] = bandEnergy;
+    }
+
+    const float peak = *std::max_element(frame.begin(), frame.end());
+    if (peak <= 0.0f) {
+        settle(0, -1);
+        return;
+    }
+
+    for (size_t pc = 0; pc < 12; ++pc)
+        smoothedChroma[pc] += kSmoothing * (frame[pc] / peak - smoothedChroma[pc]);
+
+    const float smoothedPeak = *std::max_element(smoothedChroma.begin(), smoothedChroma.end());
+    if (smoothedPeak > 0.0f)
+        juce::FloatVectorOperations::multiply(smoothedChroma.data(), 1.0f / smoothedPeak, 12);
+
+    // The bass is the lowest strong note, not the loudest: window leakage
+    // spreads low partials over narrow bands and favours higher notes.
+    const float bassPeak = *std::max_element(bassEnergy.begin(), bassEnergy.end());
+    int bassPc = -1;
+    for (int band = 0; band < kBassNotes && bassPeak > 0.0f; ++band) {
+        if (bassEnergy[static_cast<size_t>(band)] >= kBassThreshold * bassPeak) {
+            bassPc = (kLowestNote + band) % 12;
+            break;
+        }
+    }
+
+    settle(strongestTones(), bassPc);
+}
+
+void ChromagramAnalyzer::settle(uint16_t tones, int bassPc) {
+    if (tones == candidateTones && bassPc == candidateBass) {
+        ++candidateFrames;
+    } else {
+        candidateTones = tones;
+        candidateBass = bassPc;
+        candidateFrames = 1;
+    }
+
+    if (candidateFrames >= kStableFrames) {
+        stableTones = candidateTones;
+        stableBass = candidateBass;
+    }
+}
+
+uint16_t ChromagramAnalyzer::strongestTones() const {
+    std::array<int, 12> order{};
+    for (int pc = 0; pc < 12; ++pc)
+        order[static_cast<size_t>(pc)] = pc;
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return smoothedChroma[static_cast<size_t>(a)] > smoothedChroma[static_cast<size_t>(b)];
+    });
+
+    uint16_t set = 0;
+    for (int i = 0; i < kMaxTones; ++i) {
+        int pc = order[static_cast<size_t>(i)];
+        if (smoothedChroma[static_cast<size_t>(pc)] < kToneThreshold)
+            break;
+        set |= static_cast<uint16_t>(1u << pc);
+    }
+    return set;
+}
+
+} // namespace chordpumper
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chordpumper {
+
+// Streaming chromagram front end for audio chord following.
+//
+// Input is mixed to mono, low-passed and decimated to roughly 12 kHz, then a
+// Hann-windowed 4096-point FFT (2.9 Hz bins) runs every 256 decimated samples
+// (~21 ms). Magnitudes are summed per semitone band (E2 to C7) and folded
+// into 12 pitch classes. Every buffer is sized in prepare(); process() never
+// allocates or locks.
+class ChromagramAnalyzer {
+public:
+    static constexpr int kFftOrder = 12;
+    static constexpr int kFftSize = 1 << kFftOrder;
+    static constexpr int kHopSize = 256;
+    static constexpr double kTargetAnalysisRate = 12000.0;
+    static constexpr int kLowestNote = 40;   // E2
+    static constexpr int kHighestNote = 96;  // C7
+    static constexpr int kBassNotes = 24;    // bass is taken from the lowest two octaves
+
+    void prepare(double sampleRate, int maxBlockSize);
+    void reset();
+
+    // Returns true when at least one new analysis frame completed.
+    bool process(const float* const* channels, int numChannels, int numSamples);
+
+    // Smoothed chroma, normalised so the strongest pitch class is 1.
+    const std::array<float, 12>& chroma() const { return smoothedChroma; }
+
+    // Pitch classes loud enough to be chord tones, and the lowest strong pitch
+    // class in the bass range (-1 in silence). Both only change once a new
+    // reading has held for kStableFrames, so transitions between chords do not
+    // report the blend of the two.
+    uint16_t activePitchClasses() const { return stableTones; }
+    int bassPitchClass() const { return stableBass; }
+
+    // The bass when it is one of the active pitch classes, otherwise -1, so a
+    // non-chord tone in the bass range never names a chord's root.
+    int chordBassPitchClass() const {
+        return stableBass >= 0 && (stableTones & (1u << stableBass)) != 0 ? stableBass : -1;
+    }
+
+    double getAnalysisRate() const { return analysisRate; }
+
+    // Below this RMS (after decimation) frames are treated as silence.
+    static constexpr float kSilenceRms = 1.0e-3f;
+    static constexpr float kToneThreshold = 0.35f;  // relative to the strongest pitch class
+    static constexpr float kSmoothing = 0.5f;
+    static constexpr float kBassThreshold = 0.5f;  // relative to the loudest bass-range note
+    static constexpr int kMaxTones = 4;
+    static constexpr int kStableFrames = 8;         // ~170 ms
+
+private:
+    void analyseFrame();
+    uint16_t strongestTones() const;
+    void settle(uint16_t tones, int bassPc);
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> window;
+    std::vector<float> history;   // circular, kFftSize decimated samples
+    std::vector<float> fftData;   // 2 * kFftSize, as required by the FFT
+    std::vector<int> bandStart;   // first FFT bin of each semitone band
+    std::vector<int> bandEnd;     // one past the last bin
+    std::array<juce::dsp::IIR::Filter<float>, 2> antiAlias;
+
+    std::array<float, 12> smoothedChroma{};
+    uint16_t candidateTones = 0;
+    int candidateBass = -1;
+    int candidateFrames = 0;
+    uint16_t stableTones = 0;
+    int stableBass = -1;
+
+    double analysisRate = kTargetAnalysisRate;
+    int decimation = 1;
+    int decimationPhase = 0;
+    int writePosition = 0;
+    int samplesSinceFrame = 0;
+};
+
+} // namespace chordpumper
@@ -11,7 +11,8 @@ struct Chord {
     PitchClass root;
     ChordType type;
     int octaveOffset = 0;         // semitone octave shift applied at preview/playback (+1 = up, -1 = down)
-    std::string romanNumeral;     // Roman numeral label captured at drag time (e.g. "IV", "vi")
+    std::string romanNumeral{};   // Roman numeral label captured at drag time (e.g. "IV", "vi")
+    double lengthBeats = 0.0;     // length in the progression, in quarter notes (0 = one bar)
 
     int noteCount() const;
     std::vector<int> midiNotes(int octave) const;
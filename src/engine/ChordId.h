@@ -0,0 +1,38 @@
+#pragma once
+
+#include "engine/Chord.h"
+#include "engine/ChordType.h"
+#include "engine/PitchClass.h"
+#include <cstdint>
+
+namespace chordpumper {
+
+// Compact chord identity: index into kAllChords (root semitone * 18 + type).
+// Fits in a byte so it can be published through atomics and stored in tables.
+using ChordId = uint8_t;
+
+inline constexpr int kNumChordTypes = 18;
+inline constexpr int kNumChordIds = 12 * kNumChordTypes;
+inline constexpr ChordId kNoChord = 0xff;
+
+inline constexpr ChordId makeChordId(int rootSemitone, ChordType type) {
+    return static_cast<ChordId>(rootSemitone * kNumChordTypes + static_cast<int>(type));
+}
+
+inline constexpr ChordId chordIdOf(const Chord& chord) {
+    return makeChordId(chord.root.semitone(), chord.type);
+}
+
+inline constexpr int chordIdRoot(ChordId id) {
+    return id / kNumChordTypes;
+}
+
+inline constexpr ChordType chordIdType(ChordId id) {
+    return static_cast<ChordType>(id % kNumChordTypes);
+}
+
+inline Chord chordFromId(ChordId id) {
+    return Chord{pitchClassFromSemitone(chordIdRoot(id)), chordIdType(id)};
+}
+
+} // namespace chordpumper
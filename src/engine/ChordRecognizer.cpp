@@ -0,0 +1,87 @@
+#include "engine/ChordRecognizer.h"
+#include <bit>
+
+namespace chordpumper {
+
+void ChordRecognizer::noteOn(int note) {
+    if (note < 0 || note > 127)
+        return;
+
+    auto n = static_cast<size_t>(note);
+    if (noteCount[n]++ != 0)
+        return;
+
+    if (note < 64)
+        heldLow |= uint64_t{1} << note;
+    else
+        heldHigh |= uint64_t{1} << (note - 64);
+
+    auto pc = static_cast<size_t>(note % 12);
+    if (pitchClassCount[pc]++ == 0)
+        heldPitchClasses |= static_cast<uint16_t>(1u << pc);
+}
+
+void ChordRecognizer::noteOff(int note) {
+    if (note < 0 || note > 127)
+        return;
+
+    auto n = static_cast<size_t>(note);
+    if (noteCount[n] == 0 || --noteCount[n] != 0)
+        return;
+
+    if (note < 64)
+        heldLow &= ~(uint64_t{1} << note);
+    else
+        heldHigh &= ~(uint64_t{1} << (note - 64));
+
+    auto pc = static_cast<size_t>(note % 12);
+    if (--pitchClassCount[pc] == 0)
+        heldPitchClasses &= static_cast<uint16_t>(~(1u << pc));
+}
+
+void ChordRecognizer::reset() {
+    noteCount.fill(0);
+    pitchClassCount.fill(0);
+    heldLow = 0;
+    heldHigh = 0;
+    heldPitchClasses = 0;
+}
+
+int ChordRecognizer::lowestNote() const {
+    if (heldLow != 0)
+        return std::countr_zero(heldLow);
+    if (heldHigh != 0)
+        return 64 + std::countr_zero(heldHigh);
+    return -1;
+}
+
+RecognizedChord ChordRecognizer::recognize() const {
+    int bass = lowestNote();
+    return lookup(heldPitchClasses, bass < 0 ? -1 : bass % 12);
+}
+
+RecognizedChord ChordRecognizer::lookup(uint16_t pitchClasses, int bassPitchClass) {
+    RecognizedChord result;
+    result.bass = static_cast<int8_t>(bassPitchClass);
+
+    ChordId id = kChordLookup[pitchClasses & 0x0fff];
+    if (id == kNoChord)
+        return result;
+
+    auto type = chordIdType(id);
+    int root = chordIdRoot(id);
+
+    // Augmented and diminished sevenths are symmetric: name them from the bass.
+    if (bassPitchClass >= 0 && (type == ChordType::Augmented || type == ChordType::Dim7))
+        root = bassPitchClass;
+
+    result.id = makeChordId(root, type);
+    if (bassPitchClass >= 0) {
+        int interval = (bassPitchClass - root + 12) % 12;
+        auto position = kInversionOfInterval[static_cast<size_t>(type)][static_cast<size_t>(interval)];
+        result.inversion = static_cast<uint8_t>(position < 0 ? 0 : position);
+    }
+    return result;
+}
+
+} // namespace chordpumper
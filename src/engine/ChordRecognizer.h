@@ -0,0 +1,118 @@
+#pragma once
+
+#include "engine/ChordId.h"
+#include "engine/ChordType.h"
+#include <array>
+#include <cstdint>
+
+namespace chordpumper {
+
+namespace detail {
+
+inline constexpr uint16_t rotatedSet(ChordType type, int root, bool omitFifth) {
+    uint16_t set = 0;
+    const auto& intervals = kIntervals[static_cast<size_t>(type)];
+    for (int i = 0; i < noteCount(type); ++i) {
+        int interval = intervals[static_cast<size_t>(i)];
+        if (omitFifth && interval == 7)
+            continue;
+        set |= static_cast<uint16_t>(1u << ((root + interval) % 12));
+    }
+    return set;
+}
+
+// Complete voicings are entered first, so they win over a fifth-less voicing
+// of another chord. Within a pass, types and roots are visited in kAllChords
+// order; symmetric chords (aug, dim7) are re-rooted on the bass at lookup.
+inline constexpr std::array<ChordId, 4096> buildChordLookup() {
+    std::array<ChordId, 4096> table{};
+    for (auto& entry : table)
+        entry = kNoChord;
+
+    for (bool omitFifth : {false, true}) {
+        for (int t = 0; t < kNumChordTypes; ++t) {
+            auto type = static_cast<ChordType>(t);
+            if (omitFifth && noteCount(type) < 4)
+                continue;
+            for (int root = 0; root < 12; ++root) {
+                auto set = rotatedSet(type, root, omitFifth);
+                if (table[set] == kNoChord)
+                    table[set] = makeChordId(root, type);
+            }
+        }
+    }
+    return table;
+}
+
+// Position of each interval (mod 12) in a chord type's tone list, or -1.
+inline constexpr std::array<std::array<int8_t, 12>, kNumChordTypes> buildInversionTable() {
+    std::array<std::array<int8_t, 12>, kNumChordTypes> table{};
+    for (int t = 0; t < kNumChordTypes; ++t) {
+        for (auto& entry : table[static_cast<size_t>(t)])
+            entry = -1;
+        auto type = static_cast<ChordType>(t);
+        for (int i = 0; i < noteCount(type); ++i) {
+            int interval = kIntervals[static_cast<size_t>(t)][static_cast<size_t>(i)] % 12;
+            table[static_cast<size_t>(t)][static_cast<size_t>(interval)] = static_cast<int8_t>(i);
+        }
+    }
+    return table;
+}
+
+} // namespace detail
+
+// Maps every 12-bit pitch-class set to the chord it spells (kNoChord if none).
+inline constexpr auto kChordLookup = detail::buildChordLookup();
+inline constexpr auto kInversionOfInterval = detail::buildInversionTable();
+
+struct RecognizedChord {
+    ChordId id = kNoChord;
+    uint8_t inversion = 0;  // 0 = root position, 1 = third in the bass, ...
+    int8_t bass = -1;       // bass pitch class, -1 when nothing is held
+
+    bool isValid() const { return id != kNoChord; }
+    bool operator==(const RecognizedChord&) const = default;
+};
+
+// Packs a recognition and a change counter into one word so the audio thread
+// can publish it through a single atomic store.
+inline uint32_t packRecognizedChord(const RecognizedChord& c, uint8_t serial) {
+    return static_cast<uint32_t>(c.id)
+         | static_cast<uint32_t>(c.inversion) << 8
+         | static_cast<uint32_t>(static_cast<uint8_t>(c.bass)) << 16
+         | static_cast<uint32_t>(serial) << 24;
+}
+
+inline RecognizedChord unpackRecognizedChord(uint32_t packed) {
+    return {static_cast<ChordId>(packed & 0xff),
+            static_cast<uint8_t>((packed >> 8) & 0xff),
+            static_cast<int8_t>(static_cast<uint8_t>((packed >> 16) & 0xff))};
+}
+
+inline uint8_t recognizedChordSerial(uint32_t packed) {
+    return static_cast<uint8_t>(packed >> 24);
+}
+
+// Tracks held MIDI notes and names the chord they form. Every method is O(1),
+// allocation-free and lock-free, so it runs directly on the audio thread.
+class ChordRecognizer {
+public:
+    void noteOn(int note);
+    void noteOff(int note);
+    void reset();
+
+    uint16_t pitchClasses() const { return heldPitchClasses; }
+    int lowestNote() const;
+    RecognizedChord recognize() const;
+
+    static RecognizedChord lookup(uint16_t pitchClasses, int bassPitchClass);
+
+private:
+    std::array<uint8_t, 128> noteCount{};   // a note can be held on several channels
+    std::array<uint8_t, 12> pitchClassCount{};
+    uint64_t heldLow = 0;   // notes 0-63
+    uint64_t heldHigh = 0;  // notes 64-127
+    uint16_t heldPitchClasses = 0;
+};
+
+} // namespace chordpumper
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "engine/Chord.h"
+#include "engine/ChordType.h"
+#include <algorithm>
+#include <array>
+
+namespace chordpumper {
+
+// Complexity tiers: each chord type's family at triad, 7th, 9th, 11th and 13th
+// level. Raising the complexity lifts a chord to at least that tier; it never
+// strips extensions the engine chose, so tier 0 shows the suggestions as scored.
+inline constexpr int kNumComplexityTiers = 5;
+
+using TierRow = std::array<ChordType, kNumComplexityTiers>;
+
+inline constexpr std::array<TierRow, 18> kComplexityTiers = {{
+    {ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13},        // Major
+    {ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13},        // Minor
+    {ChordType::Diminished, ChordType::HalfDim7, ChordType::HalfDim7, ChordType::HalfDim7,
+     ChordType::HalfDim7},                                                                           // Diminished
+    {ChordType::Augmented, ChordType::Augmented, ChordType::Augmented, ChordType::Augmented,
+     ChordType::Augmented},                                                                          // Augmented
+    {ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13},        // Maj7
+    {ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13},        // Min7
+    {ChordType::Major, ChordType::Dom7, ChordType::Dom9, ChordType::Dom11, ChordType::Dom13},        // Dom7
+    {ChordType::Diminished, ChordType::Dim7, ChordType::Dim7, ChordType::Dim7, ChordType::Dim7},    // Dim7
+    {ChordType::Diminished, ChordType::HalfDim7, ChordType::HalfDim7, ChordType::HalfDim7,
+     ChordType::HalfDim7},                                                                           // HalfDim7
+    {ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13},        // Maj9
+    {ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13},        // Maj11
+    {ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13},        // Maj13
+    {ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13},        // Min9
+    {ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13},        // Min11
+    {ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13},        // Min13
+    {ChordType::Major, ChordType::Dom7, ChordType::Dom9, ChordType::Dom11, ChordType::Dom13},        // Dom9
+    {ChordType::Major, ChordType::Dom7, ChordType::Dom9, ChordType::Dom11, ChordType::Dom13},        // Dom11
+    {ChordType::Major, ChordType::Dom7, ChordType::Dom9, ChordType::Dom11, ChordType::Dom13},        // Dom13
+}};
+
+// The tier a chord type already sits at: triads 0, 7ths 1, 9ths 2, 11ths 3, 13ths 4.
+inline constexpr int extensionTier(ChordType type) {
+    switch (type) {
+        case ChordType::Maj9: case ChordType::Min9: case ChordType::Dom9:
+            return 2;
+        case ChordType::Maj11: case ChordType::Min11: case ChordType::Dom11:
+            return 3;
+        case ChordType::Maj13: case ChordType::Min13: case ChordType::Dom13:
+            return 4;
+        default:
+            return noteCount(type) == 3 ? 0 : 1;
+    }
+}
+
+// Maps the 0..1 complexity control onto a tier.
+inline constexpr int complexityTier(float complexity) {
+    int tier = static_cast<int>(complexity * static_cast<float>(kNumComplexityTiers - 1) + 0.5f);
+    return std::clamp(tier, 0, kNumComplexityTiers - 1);
+}
+
+inline constexpr ChordType typeAtTier(ChordType type, int tier) {
+    return kComplexityTiers[static_cast<size_t>(type)][static_cast<size_t>(std::max(tier, extensionTier(type)))];
+}
+
+// The four variations offered in a pad's quadrants, if the type has any.
+struct SubVariations {
+    bool available;
+    std::array<ChordType, 4> types;
+};
+
+inline constexpr std::array<SubVariations, 18> kSubVariations = {{
+    {true,  {ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj13}},   // Major
+    {true,  {ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11}},   // Minor
+    {false, {}},                                                                       // Diminished
+    {false, {}},                                                                       // Augmented
+    {true,  {ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13}},   // Maj7
+    {true,  {ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13}},   // Min7
+    {true,  {ChordType::Dom7, ChordType::Dom9, ChordType::Dom11, ChordType::Dom13}},   // Dom7
+    {false, {}},                                                                       // Dim7
+    {false, {}},                                                                       // HalfDim7
+    {false, {}},                                                                       // Maj9
+    {false, {}},                                                                       // Maj11
+    {false, {}},                                                                       // Maj13
+    {false, {}},                                                                       // Min9
+    {false, {}},                                                                       // Min11
+    {false, {}},                                                                       // Min13
+    {false, {}},                                                                       // Dom9
+    {false, {}},                                                                       // Dom11
+    {false, {}},                                                                       // Dom13
+}};
+
+// What a pad shows and plays at a complexity tier: its chord lifted to the
+// tier, and that chord's quadrant variations if the lifted type has any.
+struct PadChords {
+    Chord chord;
+    bool hasSubChords = false;
+    std::array<Chord, 4> subChords{};
+};
+
+inline PadChords padChordsAtTier(const Chord& chord, int tier) {
+    PadChords pad;
+    pad.chord = chord;
+    pad.chord.type = typeAtTier(chord.type, tier);
+
+    const auto& variations = kSubVariations[static_cast<size_t>(pad.chord.type)];
+    pad.hasSubChords = variations.available;
+    if (pad.hasSubChords) {
+        for (size_t q = 0; q < pad.subChords.size(); ++q)
+            pad.subChords[q] = Chord{chord.root, variations.types[q]};
+    }
+    return pad;
+}
+
+static_assert(typeAtTier(ChordType::Major, 0) == ChordType::Major);
+static_assert(typeAtTier(ChordType::Dom7, 0) == ChordType::Dom7);
+static_assert(typeAtTier(ChordType::Dom7, 4) == ChordType::Dom13);
+static_assert(typeAtTier(ChordType::Min11, 2) == ChordType::Min11);
+static_assert(complexityTier(1.0f) == kNumComplexityTiers - 1);
+
+} // namespace chordpumper
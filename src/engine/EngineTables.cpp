@@ -0,0 +1,61 @@
+#include "engine/EngineTables.h"
+#include "engine/RomanNumeral.h"
+#include "engine/ScaleDatabase.h"
+#include "diagnostics/Trace.h"
+#include <algorithm>
+#include <mutex>
+
+namespace chordpumper {
+
+namespace {
+
+constexpr std::array<float, 7> kModeScores = {
+    1.00f, // Ionian
+    0.75f, // Dorian
+    0.60f, // Phrygian
+    0.70f, // Lydian
+    0.80f, // Mixolydian
+    0.85f, // Aeolian
+    0.60f, // Locrian
+};
+
+} // anonymous namespace
+
+std::shared_ptr<const EngineTables> EngineTables::shared() {
+    static std::mutex mutex;
+    static std::weak_ptr<const EngineTables> instance;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto tables = instance.lock();
+    if (tables == nullptr) {
+        tables = std::make_shared<const EngineTables>();
+        instance = tables;
+    }
+    return tables;
+}
+
+EngineTables::EngineTables() {
+    CHORDPUMPER_TRACE_SCOPE("EngineTables::build");
+
+    for (size_t mode = 0; mode < kModePatterns.size(); ++mode) {
+        const auto& pattern = kModePatterns[mode];
+        for (size_t degree = 0; degree < 7; ++degree) {
+            auto& row = diatonicScores[static_cast<size_t>(pattern.intervals[degree])];
+            for (auto type : {pattern.triadQualities[degree], pattern.seventhQualities[degree]}) {
+                auto& score = row[static_cast<size_t>(type)];
+                score = std::max(score, kModeScores[mode]);
+            }
+        }
+    }
+
+    const Chord reference{pitches::C, ChordType::Major};
+    for (int interval = 0; interval < 12; ++interval) {
+        for (int t = 0; t < kNumChordTypes; ++t) {
+            auto type = static_cast<ChordType>(t);
+            romanNumerals[static_cast<size_t>(interval)][static_cast<size_t>(t)] =
+                chordpumper::romanNumeral(reference, Chord{pitchClassFromSemitone(interval), type});
+        }
+    }
+}
+
+} // namespace chordpumper
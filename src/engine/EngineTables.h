@@ -0,0 +1,37 @@
+#pragma once
+
+#include "engine/ChordId.h"
+#include <array>
+#include <memory>
+#include <string>
+
+namespace chordpumper {
+
+// Read-only lookup tables every engine user needs, indexed by the interval
+// from the reference root (0-11) and the candidate's chord type.
+//
+// One copy per process: shared() builds the tables on first use and hands
+// out references to it. The last owner to let go frees them, and the next
+// shared() builds them again. Later instances in a project pay for one
+// weak_ptr lock, not a rebuild.
+class EngineTables {
+public:
+    static std::shared_ptr<const EngineTables> shared();
+
+    // Best mode-weighted diatonic fit (see MorphEngine::scoreDiatonic).
+    float diatonicScore(int interval, ChordType type) const {
+        return diatonicScores[static_cast<size_t>(interval)][static_cast<size_t>(type)];
+    }
+
+    const std::string& romanNumeral(int interval, ChordType type) const {
+        return romanNumerals[static_cast<size_t>(interval)][static_cast<size_t>(type)];
+    }
+
+    EngineTables();
+
+private:
+    std::array<std::array<float, kNumChordTypes>, 12> diatonicScores{};
+    std::array<std::array<std::string, kNumChordTypes>, 12> romanNumerals;
+};
+
+} // namespace chordpumper
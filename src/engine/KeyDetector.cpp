@@ -0,0 +1,161 @@
+#include "engine/KeyDetector.h"
+#include <cmath>
+
+namespace chordpumper {
+
+namespace {
+
+// Tonic-weighted profile for one mode, shaped like the Krumhansl-Kessler
+// probe-tone ratings: tonic > fifth > third > other scale tones > chromatic.
+// The emphasis on the tonic is what separates modes sharing a pitch set.
+constexpr std::array<float, 12> modeProfile(const ScalePattern& pattern) {
+    std::array<float, 12> profile{};
+    for (auto& weight : profile)
+        weight = 1.5f;
+    for (size_t degree = 0; degree < 7; ++degree) {
+        float weight = degree == 0 ? 6.0f
+                     : degree == 4 ? 4.5f
+                     : degree == 2 ? 4.0f
+                                   : 3.2f;
+        profile[static_cast<size_t>(pattern.intervals[degree])] = weight;
+    }
+    return profile;
+}
+
+// Profiles for all keys, transposed to [pitch class][key] so the correlation
+// is twelve contiguous 84-wide multiply-adds the compiler vectorises. Each
+// key's profile is centred and scaled to unit length, which makes the dot
+// product with a centred histogram its Pearson correlation up to one factor.
+struct KeyProfiles {
+    alignas(32) std::array<std::array<float, KeyDetector::kNumKeys>, 12> weights{};
+
+    KeyProfiles() {
+        for (int mode = 0; mode < KeyDetector::kNumModes; ++mode) {
+            auto profile = modeProfile(kModePatterns[static_cast<size_t>(mode)]);
+            float mean = 0.0f;
+            for (float w : profile)
+                mean += w;
+            mean /= 12.0f;
+            float norm = 0.0f;
+            for (float& w : profile) {
+                w -= mean;
+                norm += w * w;
+            }
+            norm = std::sqrt(norm);
+
+            for (int tonic = 0; tonic < 12; ++tonic)
+                for (int pc = 0; pc < 12; ++pc)
+                    weights[static_cast<size_t>(pc)][static_cast<size_t>(mode * 12 + tonic)] =
+                        profile[static_cast<size_t>((pc - tonic + 12) % 12)] / norm;
+        }
+    }
+};
+
+const KeyProfiles kProfiles;
+
+KeyEstimate bestOf(const std::array<float, KeyDetector::kNumKeys>& scores) {
+    size_t best = 0;
+    for (size_t key = 1; key < scores.size(); ++key)
+        if (scores[key] > scores[best])
+            best = key;
+
+    return {static_cast<int8_t>(best % 12), static_cast<uint8_t>(best / 12),
+            scores[best] > 0.0f ? scores[best] : 0.0f};
+}
+
+} // anonymous namespace
+
+void KeyDetector::prepare(double newSampleRate) {
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    reset();
+}
+
+void KeyDetector::reset() {
+    pitchHistogram.fill(0.0f);
+    current = {};
+    samplesSinceUpdate = 0;
+    dirty = false;
+}
+
+void KeyDetector::noteOn(int note, float velocity) {
+    if (note < 0 || note > 127)
+        return;
+    pitchHistogram[static_cast<size_t>(note % 12)] += velocity;
+    dirty = true;
+}
+
+bool KeyDetector::advance(int numSamples) {
+    if (numSamples <= 0)
+        return false;
+
+    auto decay = static_cast<float>(std::exp2(-numSamples / (kHalfLifeSeconds * sampleRate)));
+    for (auto& energy : pitchHistogram)
+        energy *= decay;
+
+    samplesSinceUpdate += numSamples;
+    if (samplesSinceUpdate < static_cast<int>(kUpdateIntervalSeconds * sampleRate))
+        return false;
+
+    samplesSinceUpdate = 0;
+    if (!dirty)
+        return false;
+    dirty = false;
+    return update();
+}
+
+std::array<float, KeyDetector::kNumKeys> KeyDetector::correlate(const std::array<float, 12>& histogram) {
+    float mean = 0.0f;
+    for (float h : histogram)
+        mean += h;
+    mean /= 12.0f;
+
+    std::array<float, 12> centred{};
+    float norm = 0.0f;
+    for (size_t pc = 0; pc < 12; ++pc) {
+        centred[pc] = histogram[pc] - mean;
+        norm += centred[pc] * centred[pc];
+    }
+    norm = std::sqrt(norm);
+    float scale = norm > 0.0f ? 1.0f / norm : 0.0f;
+
+    std::array<float, kNumKeys> scores{};
+    for (size_t pc = 0; pc < 12; ++pc) {
+        const float h = centred[pc] * scale;
+        const auto& row = kProfiles.weights[pc];
+        for (size_t key = 0; key < static_cast<size_t>(kNumKeys); ++key)
+            scores[key] += h * row[key];
+    }
+    return scores;
+}
+
+KeyEstimate KeyDetector::bestKey(const std::array<float, 12>& histogram) {
+    return bestOf(correlate(histogram));
+}
+
+bool KeyDetector::update() {
+    float energy = 0.0f;
+    for (float h : pitchHistogram)
+        energy += h;
+    if (energy < kMinEnergy)
+        return false;
+
+    auto scores = correlate(pitchHistogram);
+    auto candidate = bestOf(scores);
+    if (candidate.confidence < kMinConfidence)
+        return false;
+
+    if (current.isValid()) {
+        if (candidate.tonic == current.tonic && candidate.mode == current.mode) {
+            current.confidence = candidate.confidence;
+            return false;
+        }
+        float currentScore = scores[static_cast<size_t>(current.mode * 12 + current.tonic)];
+        if (candidate.confidence < currentScore + kSwitchMargin)
+            return false;
+    }
+
+    current = candidate;
+    return true;
+}
+
+} // namespace chordpumper
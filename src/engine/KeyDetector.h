@@ -0,0 +1,76 @@
+#pragma once
+
+#include "engine/ScaleDatabase.h"
+#include <array>
+#include <cstdint>
+
+namespace chordpumper {
+
+struct KeyEstimate {
+    int8_t tonic = -1;       // semitone, -1 until enough notes have been heard
+    uint8_t mode = 0;        // index into kModePatterns
+    float confidence = 0.0f; // correlation with the key profile, 0..1
+
+    bool isValid() const { return tonic >= 0; }
+};
+
+// Streaming key/mode detection from note-ons. Each note adds its velocity to
+// a pitch-class histogram that decays with a fixed half-life; at a throttled
+// rate the histogram is correlated against a profile for each of the 84
+// tonic/mode pairs. All state is fixed-size, so it runs on the audio thread.
+class KeyDetector {
+public:
+    static constexpr int kNumModes = static_cast<int>(kModePatterns.size());
+    static constexpr int kNumKeys = 12 * kNumModes;
+
+    static constexpr double kHalfLifeSeconds = 8.0;
+    static constexpr double kUpdateIntervalSeconds = 0.25;
+    // A new key must correlate this much better than the current one.
+    static constexpr float kSwitchMargin = 0.03f;
+    static constexpr float kMinConfidence = 0.45f;
+    static constexpr float kMinEnergy = 2.0f;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    void noteOn(int note, float velocity);
+
+    // Decays the histogram by numSamples of time and re-estimates when the
+    // update interval has elapsed. Returns true if the estimate changed.
+    bool advance(int numSamples);
+
+    KeyEstimate estimate() const { return current; }
+    const std::array<float, 12>& histogram() const { return pitchHistogram; }
+
+    // Correlation of a histogram with every key, indexed mode * 12 + tonic.
+    static std::array<float, kNumKeys> correlate(const std::array<float, 12>& histogram);
+
+    // Best key for a histogram, ignoring hysteresis.
+    static KeyEstimate bestKey(const std::array<float, 12>& histogram);
+
+private:
+    bool update();
+
+    std::array<float, 12> pitchHistogram{};
+    KeyEstimate current;
+    double sampleRate = 44100.0;
+    int samplesSinceUpdate = 0;
+    bool dirty = false;
+};
+
+// Packs an estimate and a change counter into one word for atomic publication.
+inline uint32_t packKeyEstimate(const KeyEstimate& k, uint8_t serial) {
+    auto confidence = static_cast<uint32_t>(k.confidence * 255.0f + 0.5f);
+    return static_cast<uint32_t>(static_cast<uint8_t>(k.tonic))
+         | static_cast<uint32_t>(k.mode) << 8
+         | (confidence > 255 ? 255u : confidence) << 16
+         | static_cast<uint32_t>(serial) << 24;
+}
+
+inline KeyEstimate unpackKeyEstimate(uint32_t packed) {
+    return {static_cast<int8_t>(static_cast<uint8_t>(packed & 0xff)),
+            static_cast<uint8_t>((packed >> 8) & 0xff),
+            static_cast<float>((packed >> 16) & 0xff) / 255.0f};
+}
+
+} // namespace chordpumper
@@ -0,0 +1,105 @@
+#include "engine/MorphCache.h"
+#include <algorithm>
+#include <tuple>
+
+namespace chordpumper {
+
+bool MorphCache::Key::operator<(const Key& other) const {
+    return std::tie(letter, accidental, type, octave, count, weights, previousNotes) <
+           std::tie(other.letter, other.accidental, other.type, other.octave, other.count,
+                    other.weights, other.previousNotes);
+}
+
+MorphCache::MorphCache(size_t capacity) : maxEntries(std::max<size_t>(capacity, 1)) {}
+
+MorphCache::Key MorphCache::makeKey(const Chord& target, const std::vector<int>& previousNotes,
+                                    int octave, const MorphWeights& weights, size_t count) {
+    return {static_cast<uint8_t>(target.root.letter),
+            target.root.accidental,
+            static_cast<uint8_t>(target.type),
+            octave,
+            count,
+            previousNotes,
+            {weights.diatonic, weights.commonTones, weights.voiceLeading}};
+}
+
+std::shared_ptr<const MorphResult> MorphCache::find(const Chord& target,
+                                                    const std::vector<int>& previousNotes,
+                                                    int octave,
+                                                    const MorphWeights& weights,
+                                                    size_t count) {
+    auto key = makeKey(target, previousNotes, octave, weights, count);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+        ++missCount;
+        return nullptr;
+    }
+    ++hitCount;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->result;
+}
+
+std::shared_ptr<const MorphResult> MorphCache::insert(const Chord& target,
+                                                      const std::vector<int>& previousNotes,
+                                                      int octave,
+                                                      const MorphWeights& weights,
+                                                      MorphResult result,
+                                                      size_t count) {
+    auto key = makeKey(target, previousNotes, octave, weights, count);
+    auto stored = std::make_shared<const MorphResult>(std::move(result));
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (auto it = index.find(key); it != index.end()) {
+        it->second->result = stored;
+        entries.splice(entries.begin(), entries, it->second);
+        return stored;
+    }
+
+    if (entries.size() >= maxEntries) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front({key, stored});
+    index.emplace(std::move(key), entries.begin());
+    return stored;
+}
+
+bool MorphCache::contains(const Chord& target, const std::vector<int>& previousNotes,
+                          int octave, const MorphWeights& weights, size_t count) const {
+    auto key = makeKey(target, previousNotes, octave, weights, count);
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.count(key) > 0;
+}
+
+void MorphCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    entries.clear();
+}
+
+size_t MorphCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+uint64_t MorphCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+uint64_t MorphCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+MorphResult MorphCache::compute(const MorphEngine& engine, const Chord& target,
+                                const std::vector<int>& previousNotes, int octave,
+                                size_t count) {
+    auto voiced = optimalVoicing(target, previousNotes, octave);
+    auto suggestions = engine.morph(target, voiced.midiNotes, count);
+    return {std::move(voiced), std::move(suggestions)};
+}
+
+} // namespace chordpumper
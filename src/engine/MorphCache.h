@@ -0,0 +1,88 @@
+#pragma once
+
+#include "engine/MorphEngine.h"
+#include "engine/VoiceLeader.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chordpumper {
+
+// Everything GridPanel::morphTo needs for one target chord.
+struct MorphResult {
+    VoicedChord voiced;
+    std::vector<ScoredChord> suggestions;
+};
+
+// Bounded LRU cache of morph results, keyed on the target chord, the voicing
+// it is led from, the engine weights and the number of suggestions.
+// Thread-safe: the UI looks results up while the prefetcher fills it in the
+// background.
+class MorphCache {
+public:
+    explicit MorphCache(size_t capacity = 128);
+
+    std::shared_ptr<const MorphResult> find(const Chord& target,
+                                            const std::vector<int>& previousNotes,
+                                            int octave,
+                                            const MorphWeights& weights,
+                                            size_t count = MorphEngine::kDefaultCount);
+
+    // Inserts (or replaces) an entry and returns the stored result.
+    std::shared_ptr<const MorphResult> insert(const Chord& target,
+                                              const std::vector<int>& previousNotes,
+                                              int octave,
+                                              const MorphWeights& weights,
+                                              MorphResult result,
+                                              size_t count = MorphEngine::kDefaultCount);
+
+    bool contains(const Chord& target, const std::vector<int>& previousNotes,
+                  int octave, const MorphWeights& weights,
+                  size_t count = MorphEngine::kDefaultCount) const;
+
+    void clear();
+    size_t size() const;
+    size_t capacity() const { return maxEntries; }
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+    // Runs voicing and morph exactly as GridPanel::morphTo does uncached.
+    static MorphResult compute(const MorphEngine& engine, const Chord& target,
+                               const std::vector<int>& previousNotes, int octave,
+                               size_t count = MorphEngine::kDefaultCount);
+
+private:
+    struct Key {
+        uint8_t letter;
+        int8_t accidental;
+        uint8_t type;
+        int octave;
+        size_t count;
+        std::vector<int> previousNotes;
+        std::array<float, 3> weights;
+
+        bool operator<(const Key& other) const;
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const MorphResult> result;
+    };
+
+    static Key makeKey(const Chord& target, const std::vector<int>& previousNotes,
+                       int octave, const MorphWeights& weights, size_t count);
+
+    size_t maxEntries;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // most recently used first
+    std::map<Key, std::list<Entry>::iterator> index;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+
+} // namespace chordpumper
@@ -1,8 +1,7 @@
 #include "engine/MorphEngine.h"
 #include "engine/PitchClassSet.h"
-#include "engine/ScaleDatabase.h"
 #include "engine/VoiceLeader.h"
-#include "engine/RomanNumeral.h"
+#include "diagnostics/Trace.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -12,16 +11,6 @@ namespace chordpumper {
 
 namespace {
 
-constexpr std::array<float, 7> kModeScores = {
-    1.00f, // Ionian
-    0.75f, // Dorian
-    0.60f, // Phrygian
-    0.70f, // Lydian
-    0.80f, // Mixolydian
-    0.85f, // Aeolian
-    0.60f, // Locrian
-};
-
 constexpr int kCategoryCount = 3;
 
 int qualityCategoryIndex(ChordType type) {
@@ -42,29 +31,15 @@ int qualityCategoryIndex(ChordType type) {
 
 float MorphEngine::scoreDiatonic(const PitchClass& referenceRoot,
                                   const Chord& candidate) const {
-    int refSemitone = referenceRoot.semitone();
-    int candSemitone = candidate.root.semitone();
-    float best = 0.0f;
-
-    for (size_t mode = 0; mode < 7; ++mode) {
-        const auto& pattern = kModePatterns[mode];
-        for (size_t degree = 0; degree < 7; ++degree) {
-            int degreeRoot = (refSemitone + pattern.intervals[degree]) % 12;
-            if (degreeRoot != candSemitone)
-                continue;
-            if (candidate.type == pattern.triadQualities[degree] ||
-                candidate.type == pattern.seventhQualities[degree]) {
-                best = std::max(best, kModeScores[mode]);
-            }
-        }
-    }
-
-    return best;
+    int interval = (candidate.root.semitone() - referenceRoot.semitone() + 12) % 12;
+    return tables->diatonicScore(interval, candidate.type);
 }
 
-std::array<ScoredChord, 64> MorphEngine::morph(
+std::vector<ScoredChord> MorphEngine::morph(
     const Chord& reference,
-    const std::vector<int>& currentVoicing) const {
+    const std::vector<int>& currentVoicing,
+    size_t count) const {
+    CHORDPUMPER_TRACE_SCOPE("MorphEngine::morph");
 
     std::vector<int> vlBaseline = currentVoicing;
     if (vlBaseline.empty())
@@ -114,7 +89,8 @@ std::array<ScoredChord, 64> MorphEngine::morph(
 
         int interval = (chord.root.semitone() - refSemitone + 12) % 12;
 
-        all.push_back({{chord, composite, romanNumeral(reference, chord)},
+        // Labelled after selection; most candidates never reach the grid
+        all.push_back({{chord, composite, {}},
                        cs,
                        interval});
     }
@@ -129,12 +105,7 @@ std::array<ScoredChord, 64> MorphEngine::morph(
             seen[all[i].pcs] = i;
     }
 
-    std::vector<ScoredChord> pool;
-    pool.reserve(seen.size());
-    for (auto& [_, idx] : seen)
-        pool.push_back(std::move(all[idx].sc));
-
-    // Deterministic sort: score desc → interval asc → type asc
+    // Deterministic order: score desc → interval asc → type asc
     auto cmp = [refSemitone](const ScoredChord& a, const ScoredChord& b) {
         if (a.score != b.score)
             return a.score > b.score;
@@ -145,19 +116,35 @@ std::array<ScoredChord, 64> MorphEngine::morph(
         return static_cast<int>(a.chord.type) < static_cast<int>(b.chord.type);
     };
 
-    std::sort(pool.begin(), pool.end(), cmp);
+    // Keeps the leaders plus an eighth in reserve for the variety filter. The
+    // heap's front is its weakest member, so each candidate costs O(log K).
+    const size_t reserveSize = std::min(seen.size(), count + count / 8);
+    std::vector<ScoredChord> pool;
+    pool.reserve(reserveSize);
+    for (auto& [_, idx] : seen) {
+        auto& sc = all[idx].sc;
+        if (pool.size() < reserveSize) {
+            pool.push_back(std::move(sc));
+            std::push_heap(pool.begin(), pool.end(), cmp);
+        } else if (reserveSize > 0 && cmp(sc, pool.front())) {
+            std::pop_heap(pool.begin(), pool.end(), cmp);
+            pool.back() = std::move(sc);
+            std::push_heap(pool.begin(), pool.end(), cmp);
+        }
+    }
+    std::sort_heap(pool.begin(), pool.end(), cmp);
 
-    size_t poolSize = std::min(pool.size(), size_t(72));
-    constexpr size_t kFinal = 64;
-    size_t selectEnd = std::min(poolSize, kFinal);
+    size_t poolSize = pool.size();
+    size_t selectEnd = std::min(poolSize, count);
+    const int minPerCategory = static_cast<int>(std::max<size_t>(1, count / 16));
 
-    // Variety post-filter: ensure >= 2 from each quality category
+    // Variety post-filter: ensure a few from each quality category
     std::array<int, kCategoryCount> catCount{};
     for (size_t i = 0; i < selectEnd; ++i)
         catCount[static_cast<size_t>(qualityCategoryIndex(pool[i].chord.type))]++;
 
     for (int cat = 0; cat < kCategoryCount; ++cat) {
-        while (catCount[static_cast<size_t>(cat)] < 4) {
+        while (catCount[static_cast<size_t>(cat)] < minPerCategory) {
             int bestRes = -1;
             for (size_t j = selectEnd; j < poolSize; ++j) {
                 if (qualityCategoryIndex(pool[j].chord.type) == cat) {
@@ -170,7 +157,7 @@ std::array<ScoredChord, 64> MorphEngine::morph(
 
             int maxCat = -1;
             for (int c = 0; c < kCategoryCount; ++c) {
-                if (catCount[static_cast<size_t>(c)] > 4 &&
+                if (catCount[static_cast<size_t>(c)] > minPerCategory &&
                     (maxCat < 0 ||
                      catCount[static_cast<size_t>(c)] >
                          catCount[static_cast<size_t>(maxCat)]))
@@ -200,11 +187,13 @@ std::array<ScoredChord, 64> MorphEngine::morph(
     std::sort(pool.begin(),
               pool.begin() + static_cast<ptrdiff_t>(selectEnd), cmp);
 
-    std::array<ScoredChord, 64> result{};
-    for (size_t i = 0; i < kFinal && i < selectEnd; ++i)
-        result[i] = std::move(pool[i]);
+    pool.resize(selectEnd);
+    for (auto& sc : pool) {
+        int interval = (sc.chord.root.semitone() - refSemitone + 12) % 12;
+        sc.romanNumeral = tables->romanNumeral(interval, sc.chord.type);
+    }
 
-    return result;
+    return pool;
 }
 
 } // namespace chordpumper
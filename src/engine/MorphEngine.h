@@ -1,8 +1,10 @@
 #pragma once
 
 #include "engine/Chord.h"
+#include "engine/EngineTables.h"
 #include "engine/PitchClass.h"
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,8 @@ struct MorphWeights {
     float diatonic = 0.40f;
     float commonTones = 0.25f;
     float voiceLeading = 0.25f;
+
+    bool operator==(const MorphWeights&) const = default;
 };
 
 struct ScoredChord {
@@ -22,13 +26,22 @@ struct ScoredChord {
 
 class MorphEngine {
 public:
+    static constexpr size_t kDefaultCount = 64;
+
     MorphWeights weights;
 
-    std::array<ScoredChord, 64> morph(const Chord& reference,
-                                       const std::vector<int>& currentVoicing) const;
+    // The best `count` candidates for the reference, best first. Only a
+    // bounded heap of the leaders is kept, so small grids sort and label less.
+    std::vector<ScoredChord> morph(const Chord& reference,
+                                   const std::vector<int>& currentVoicing,
+                                   size_t count = kDefaultCount) const;
 
     float scoreDiatonic(const PitchClass& referenceRoot,
                         const Chord& candidate) const;
+
+private:
+    // Shared by every engine in the process; see EngineTables.
+    std::shared_ptr<const EngineTables> tables = EngineTables::shared();
 };
 
 } // namespace chordpumper
@@ -35,4 +35,14 @@ namespace pitches {
     inline constexpr PitchClass B  {NoteLetter::B,  0};
 } // namespace pitches
 
+// Spelling used for each semitone when only the pitch class is known
+// (matches the roots of kAllChords).
+inline constexpr PitchClass pitchClassFromSemitone(int semitone) {
+    constexpr PitchClass spellings[12] = {
+        pitches::C, pitches::Cs, pitches::D, pitches::Eb, pitches::E, pitches::F,
+        pitches::Fs, pitches::G, pitches::Ab, pitches::A, pitches::Bb, pitches::B
+    };
+    return spellings[((semitone % 12) + 12) % 12];
+}
+
 } // namespace chordpumper
@@ -56,4 +56,8 @@ inline constexpr std::array<ScalePattern, 7> kModePatterns = {{
       ChordType::Maj7, ChordType::Dom7, ChordType::Min7}},
 }};
 
+inline constexpr std::array<const char*, 7> kModeNames = {
+    "Ionian", "Dorian", "Phrygian", "Lydian", "Mixolydian", "Aeolian", "Locrian"
+};
+
 } // namespace chordpumper
@@ -0,0 +1,128 @@
+#include "engine/TaskPool.h"
+#include <algorithm>
+
+namespace chordpumper {
+
+TaskPool::TaskPool(int numThreads) {
+    numThreads = std::max(1, numThreads);
+    for (int i = 0; i <= numThreads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < numThreads; ++i)
+        workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+TaskPool& TaskPool::shared() {
+    static TaskPool pool(static_cast<int>(std::max(1u, std::thread::hardware_concurrency() / 2)));
+    return pool;
+}
+
+void TaskPool::push(int queueIndex, const Range& range) {
+    {
+        auto& queue = *queues[static_cast<size_t>(queueIndex)];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.ranges.push_back(range);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++queuedRanges;
+    }
+    wake.notify_one();
+}
+
+bool TaskPool::popOwn(int queueIndex, Range& range) {
+    auto& queue = *queues[static_cast<size_t>(queueIndex)];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty())
+        return false;
+    range = queue.ranges.back();
+    queue.ranges.pop_back();
+    return true;
+}
+
+// Takes the oldest (largest) range from the first other queue that has one
+bool TaskPool::steal(int thiefIndex, Range& range) {
+    const int numQueues = static_cast<int>(queues.size());
+    for (int offset = 1; offset < numQueues; ++offset) {
+        auto& queue = *queues[static_cast<size_t>((thiefIndex + offset) % numQueues)];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.ranges.empty()) {
+            range = queue.ranges.front();
+            queue.ranges.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskPool::execute(int queueIndex, Range range) {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        --queuedRanges;
+    }
+
+    // Keep the lower half, offer the upper half to thieves
+    while (range.end - range.begin > 1) {
+        const int middle = range.begin + (range.end - range.begin) / 2;
+        push(queueIndex, {range.batch, middle, range.end});
+        range.end = middle;
+    }
+
+    (*range.batch->task)(range.begin);
+    if (range.batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Lock so the waiter cannot miss the notification between its check and wait
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        batchDone.notify_all();
+    }
+}
+
+bool TaskPool::runOne(int queueIndex) {
+    Range range;
+    if (!popOwn(queueIndex, range) && !steal(queueIndex, range))
+        return false;
+    execute(queueIndex, range);
+    return true;
+}
+
+void TaskPool::workerLoop(int index) {
+    for (;;) {
+        if (runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait(lock, [this] { return stopping || queuedRanges > 0; });
+        if (stopping)
+            return;
+    }
+}
+
+void TaskPool::parallelFor(int numTasks, const std::function<void(int)>& task) {
+    if (numTasks <= 0)
+        return;
+
+    Batch batch{&task, {numTasks}};
+    // Callers share the last queue; it only has to make their ranges stealable
+    const int callerQueue = static_cast<int>(queues.size()) - 1;
+    push(callerQueue, {&batch, 0, numTasks});
+
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (runOne(callerQueue))
+            continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        batchDone.wait(lock, [&] {
+            return batch.remaining.load(std::memory_order_acquire) == 0 || queuedRanges > 0;
+        });
+    }
+}
+
+} // namespace chordpumper
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chordpumper {
+
+// Work-stealing pool for batches of independent engine jobs (morph
+// precompute, analysis, export).
+//
+// parallelFor splits the index range across per-worker deques; a worker
+// halves the range it takes and leaves the other half in its own deque,
+// where idle workers steal it. The calling thread joins in until the batch
+// is done, so nested or concurrent batches cannot deadlock.
+//
+// shared() is one pool per process, sized to half the cores, so plugin
+// instances share a few threads instead of each competing with the host's
+// audio workers.
+class TaskPool {
+public:
+    explicit TaskPool(int numThreads);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    static TaskPool& shared();
+
+    // Runs task(i) for every i in [0, numTasks) and returns when all are done.
+    void parallelFor(int numTasks, const std::function<void(int)>& task);
+
+    int getNumThreads() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct Batch {
+        const std::function<void(int)>* task;
+        std::atomic<int> remaining;
+    };
+
+    struct Range {
+        Batch* batch;
+        int begin;
+        int end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    void workerLoop(int index);
+    bool runOne(int queueIndex);
+    bool popOwn(int queueIndex, Range& range);
+    bool steal(int thiefIndex, Range& range);
+    void push(int queueIndex, const Range& range);
+    void execute(int queueIndex, Range range);
+
+    // One queue per worker plus one for threads calling parallelFor
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable batchDone;
+    int queuedRanges = 0;  // guarded by wakeMutex
+    bool stopping = false;
+};
+
+} // namespace chordpumper
@@ -1,5 +1,6 @@
 #include "engine/VoiceLeader.h"
 #include "engine/ChordType.h"
+#include "diagnostics/Trace.h"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -39,6 +40,7 @@ int voiceLeadingDistance(const std::vector<int>& from, const std::vector<int>& t
 
 VoicedChord optimalVoicing(const Chord& target, const std::vector<int>& previousNotes,
                            int octave) {
+    CHORDPUMPER_TRACE_SCOPE("optimalVoicing");
     const auto& intervals = kIntervals[static_cast<int>(target.type)];
     int count = noteCount(target.type);
     int rootSemitone = target.root.semitone();
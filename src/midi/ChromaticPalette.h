@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/Chord.h"
+#include "engine/ChordTiers.h"
 #include <array>
 
 namespace chordpumper {
@@ -37,4 +38,17 @@ inline std::array<Chord, 64> chromaticPalette()
     }};
 }
 
+// Fills the largest (16x8) grid: rows 8-15 repeat rows 0-7 at the ninth tier.
+inline std::array<Chord, 128> extendedChromaticPalette()
+{
+    auto palette = chromaticPalette();
+    std::array<Chord, 128> extended;
+    for (size_t i = 0; i < palette.size(); ++i)
+    {
+        extended[i] = palette[i];
+        extended[i + palette.size()] = Chord{palette[i].root, typeAtTier(palette[i].type, 2)};
+    }
+    return extended;
+}
+
 } // namespace chordpumper
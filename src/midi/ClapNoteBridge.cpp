@@ -0,0 +1,174 @@
+#include "midi/ClapNoteBridge.h"
+#include "midi/MpeOutput.h"
+#include <algorithm>
+#include <cmath>
+
+namespace chordpumper {
+
+namespace {
+
+int toSevenBit(double normalised) {
+    return std::clamp(static_cast<int>(std::lround(normalised * 127.0)), 0, 127);
+}
+
+double semitonesFromPitchBend(int pitchBend) {
+    return (pitchBend - 8192) / 8192.0 * MpeOutput::kPitchBendRange;
+}
+
+int pitchBendFromSemitones(double semitones) {
+    return std::clamp(static_cast<int>(std::lround(8192.0 + semitones / MpeOutput::kPitchBendRange * 8192.0)),
+                      0, 16383);
+}
+
+} // anonymous namespace
+
+void ClapNoteBridge::reset() {
+    noteIds.fill(-1);
+    channelKey.fill(-1);
+    channelExpression.fill({});
+    nextNoteId = 0;
+}
+
+bool ClapNoteBridge::toMidiMessage(const clap_event_header_t& event, juce::MidiMessage& message) {
+    if (event.space_id != CLAP_CORE_EVENT_SPACE_ID)
+        return false;
+
+    switch (event.type) {
+    case CLAP_EVENT_NOTE_ON:
+    case CLAP_EVENT_NOTE_OFF:
+    case CLAP_EVENT_NOTE_CHOKE: {
+        const auto& note = reinterpret_cast<const clap_event_note_t&>(event);
+        if (note.key < 0 || note.channel < 0)
+            return false;  // wildcard note-offs address every note; nothing to forward
+        const int channel = note.channel + 1;
+        message = event.type == CLAP_EVENT_NOTE_ON
+            ? juce::MidiMessage::noteOn(channel, note.key, static_cast<float>(note.velocity))
+            : juce::MidiMessage::noteOff(channel, note.key, static_cast<float>(note.velocity));
+        return true;
+    }
+    case CLAP_EVENT_NOTE_EXPRESSION: {
+        const auto& expression = reinterpret_cast<const clap_event_note_expression_t&>(event);
+        const int channel = std::max<int>(0, expression.channel) + 1;
+        switch (expression.expression_id) {
+        case CLAP_NOTE_EXPRESSION_TUNING:
+            message = juce::MidiMessage::pitchWheel(channel, pitchBendFromSemitones(expression.value));
+            return true;
+        case CLAP_NOTE_EXPRESSION_PRESSURE:
+            message = expression.key >= 0
+                ? juce::MidiMessage::aftertouchChange(channel, expression.key, toSevenBit(expression.value))
+                : juce::MidiMessage::channelPressureChange(channel, toSevenBit(expression.value));
+            return true;
+        case CLAP_NOTE_EXPRESSION_BRIGHTNESS:
+            message = juce::MidiMessage::controllerEvent(channel, MpeOutput::kTimbreController,
+                                                         toSevenBit(expression.value));
+            return true;
+        default:
+            return false;
+        }
+    }
+    case CLAP_EVENT_MIDI: {
+        const auto& midi = reinterpret_cast<const clap_event_midi_t&>(event);
+        message = juce::MidiMessage(midi.data[0], midi.data[1], midi.data[2]);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void ClapNoteBridge::pushNote(bool isNoteOn, int channel, int key, double velocity, uint32_t time,
+                              const clap_output_events_t& out) {
+    auto& noteId = noteIds[static_cast<size_t>(channel * 128 + key)];
+    if (isNoteOn) {
+        noteId = nextNoteId;
+        nextNoteId = nextNoteId == INT32_MAX ? 0 : nextNoteId + 1;
+        channelKey[static_cast<size_t>(channel)] = static_cast<int16_t>(key);
+    }
+
+    clap_event_note_t note{};
+    note.header = {sizeof(note), time, CLAP_CORE_EVENT_SPACE_ID,
+                   static_cast<uint16_t>(isNoteOn ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF), 0};
+    note.note_id = noteId;
+    note.port_index = 0;
+    note.channel = static_cast<int16_t>(channel);
+    note.key = static_cast<int16_t>(key);
+    note.velocity = velocity;
+    out.try_push(&out, &note.header);
+
+    if (!isNoteOn) {
+        noteId = -1;
+        if (channelKey[static_cast<size_t>(channel)] == key)
+            channelKey[static_cast<size_t>(channel)] = -1;
+    }
+}
+
+void ClapNoteBridge::pushExpression(clap_note_expression expressionId, int channel, double value,
+                                    uint32_t time, const clap_output_events_t& out) const {
+    const int key = channelKey[static_cast<size_t>(channel)];
+    clap_event_note_expression_t expression{};
+    expression.header = {sizeof(expression), time, CLAP_CORE_EVENT_SPACE_ID, CLAP_EVENT_NOTE_EXPRESSION, 0};
+    expression.expression_id = expressionId;
+    expression.note_id = noteIds[static_cast<size_t>(channel * 128 + key)];
+    expression.port_index = 0;
+    expression.channel = static_cast<int16_t>(channel);
+    expression.key = static_cast<int16_t>(key);
+    expression.value = value;
+    out.try_push(&out, &expression.header);
+}
+
+void ClapNoteBridge::pushMidi(const juce::MidiMessage& message, uint32_t time,
+                              const clap_output_events_t& out) const {
+    if (message.getRawDataSize() > 3)
+        return;
+
+    clap_event_midi_t midi{};
+    midi.header = {sizeof(midi), time, CLAP_CORE_EVENT_SPACE_ID, CLAP_EVENT_MIDI, 0};
+    midi.port_index = 0;
+    std::copy_n(message.getRawData(), message.getRawDataSize(), midi.data);
+    out.try_push(&out, &midi.header);
+}
+
+void ClapNoteBridge::write(const juce::MidiBuffer& events, const clap_output_events_t& out) {
+    for (const auto metadata : events) {
+        const auto message = metadata.getMessage();
+        const auto time = static_cast<uint32_t>(metadata.samplePosition);
+        const int channel = message.getChannel() - 1;
+
+        if (message.isNoteOnOrOff()) {
+            pushNote(message.isNoteOn(), channel, message.getNoteNumber(), message.getFloatVelocity(), time, out);
+            // Start the voice with the expression its channel was given
+            if (message.isNoteOn() && channel > 0) {
+                const auto& e = channelExpression[static_cast<size_t>(channel)];
+                pushExpression(CLAP_NOTE_EXPRESSION_TUNING, channel, semitonesFromPitchBend(e.pitchBend), time, out);
+                pushExpression(CLAP_NOTE_EXPRESSION_PRESSURE, channel, e.pressure / 127.0, time, out);
+                pushExpression(CLAP_NOTE_EXPRESSION_BRIGHTNESS, channel, e.timbre / 127.0, time, out);
+            }
+            continue;
+        }
+
+        const bool isExpression = message.isPitchWheel() || message.isChannelPressure()
+            || message.isControllerOfType(MpeOutput::kTimbreController);
+        if (!isExpression || channel == 0) {
+            pushMidi(message, time, out);
+            continue;
+        }
+
+        auto& e = channelExpression[static_cast<size_t>(channel)];
+        const bool sounding = channelKey[static_cast<size_t>(channel)] >= 0;
+        if (message.isPitchWheel()) {
+            e.pitchBend = message.getPitchWheelValue();
+            if (sounding)
+                pushExpression(CLAP_NOTE_EXPRESSION_TUNING, channel, semitonesFromPitchBend(e.pitchBend), time, out);
+        } else if (message.isChannelPressure()) {
+            e.pressure = message.getChannelPressureValue();
+            if (sounding)
+                pushExpression(CLAP_NOTE_EXPRESSION_PRESSURE, channel, e.pressure / 127.0, time, out);
+        } else {
+            e.timbre = message.getControllerValue();
+            if (sounding)
+                pushExpression(CLAP_NOTE_EXPRESSION_BRIGHTNESS, channel, e.timbre / 127.0, time, out);
+        }
+    }
+}
+
+} // namespace chordpumper
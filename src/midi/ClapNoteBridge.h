@@ -0,0 +1,50 @@
+#pragma once
+
+#include <clap/clap.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Translates between CLAP's native note events and the plugin's MIDI
+// pipeline for the direct CLAP process path.
+//
+// Output notes get CLAP note IDs, and per-channel MPE expression becomes
+// per-note expression addressed by those IDs, so the host sees each chord
+// voice as its own note. Tables are fixed-size; nothing allocates.
+class ClapNoteBridge {
+public:
+    ClapNoteBridge() { reset(); }
+
+    void reset();
+
+    // Converts an incoming note, note expression or MIDI event. Returns false
+    // for anything else (parameters, transport, SysEx).
+    static bool toMidiMessage(const clap_event_header_t& event, juce::MidiMessage& message);
+
+    // Pushes events in sample order. Expression on an MPE member channel is
+    // held until that channel's note starts and is then sent as note
+    // expression for it.
+    void write(const juce::MidiBuffer& events, const clap_output_events_t& out);
+
+private:
+    struct Expression {
+        int pitchBend = 8192;
+        int pressure = 0;
+        int timbre = 64;
+    };
+
+    void pushNote(bool isNoteOn, int channel, int key, double velocity, uint32_t time,
+                  const clap_output_events_t& out);
+    void pushExpression(clap_note_expression expressionId, int channel, double value, uint32_t time,
+                        const clap_output_events_t& out) const;
+    void pushMidi(const juce::MidiMessage& message, uint32_t time, const clap_output_events_t& out) const;
+
+    std::array<int32_t, 16 * 128> noteIds{};  // by channel * 128 + key, -1 = not sounding
+    std::array<int16_t, 16> channelKey{};     // latest note on each channel, -1 = none
+    std::array<Expression, 16> channelExpression{};
+    int32_t nextNoteId = 0;
+};
+
+} // namespace chordpumper
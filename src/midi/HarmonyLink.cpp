@@ -0,0 +1,119 @@
+#include "midi/HarmonyLink.h"
+
+namespace chordpumper {
+
+namespace {
+
+bool isValidGroup(int group) {
+    return group >= 0 && group < HarmonyLink::kNumGroups;
+}
+
+} // anonymous namespace
+
+HarmonyLink& HarmonyLink::shared() {
+    static HarmonyLink link;
+    return link;
+}
+
+bool HarmonyLink::claimLeadership(int group, uint32_t instanceId) {
+    if (!isValidGroup(group))
+        return false;
+
+    auto& leader = groups[static_cast<size_t>(group)].leader;
+    uint32_t expected = 0;
+    return leader.compare_exchange_strong(expected, instanceId, std::memory_order_acq_rel)
+        || expected == instanceId;
+}
+
+void HarmonyLink::releaseLeadership(int group, uint32_t instanceId) {
+    if (!isValidGroup(group))
+        return;
+
+    auto& leader = groups[static_cast<size_t>(group)].leader;
+    if (leader.load(std::memory_order_acquire) != instanceId)
+        return;
+
+    publish(group, Harmony{});
+    uint32_t expected = instanceId;
+    leader.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+}
+
+void HarmonyLink::publish(int group, const Harmony& harmony) {
+    if (!isValidGroup(group))
+        return;
+
+    auto& g = groups[static_cast<size_t>(group)];
+    const uint32_t sequence = g.sequence.load(std::memory_order_relaxed);
+    g.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    g.payload[0].store(static_cast<uint32_t>(harmony.chord) | static_cast<uint32_t>(harmony.numNotes) << 8,
+                       std::memory_order_relaxed);
+    g.payload[1].store(harmony.key, std::memory_order_relaxed);
+    for (int word = 0; word < 2; ++word) {
+        uint32_t packed = 0;
+        for (int byte = 0; byte < 4; ++byte)
+            packed |= static_cast<uint32_t>(harmony.notes[static_cast<size_t>(word * 4 + byte)]) << (byte * 8);
+        g.payload[static_cast<size_t>(2 + word)].store(packed, std::memory_order_relaxed);
+    }
+
+    g.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool HarmonyLink::read(int group, Harmony& harmony, uint32_t& version) const {
+    if (!isValidGroup(group))
+        return false;
+
+    const auto& g = groups[static_cast<size_t>(group)];
+    for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+        const uint32_t before = g.sequence.load(std::memory_order_acquire);
+        if (before == version)
+            return false;
+        if ((before & 1u) != 0)
+            continue;
+
+        std::array<uint32_t, kPayloadWords> words;
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] = g.payload[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (g.sequence.load(std::memory_order_relaxed) != before)
+            continue;
+
+        harmony.chord = static_cast<ChordId>(words[0] & 0xff);
+        harmony.numNotes = static_cast<uint8_t>((words[0] >> 8) & 0xff);
+        harmony.key = words[1];
+        for (size_t i = 0; i < harmony.notes.size(); ++i)
+            harmony.notes[i] = static_cast<uint8_t>(words[2 + i / 4] >> ((i % 4) * 8));
+        version = before;
+        return true;
+    }
+    return false;
+}
+
+int revoiceInRegister(const HarmonyLink::Harmony& harmony, int octave,
+                      std::array<uint8_t, HarmonyLink::kMaxNotes>& notes) {
+    const int numNotes = harmony.numNotes < HarmonyLink::kMaxNotes ? harmony.numNotes : HarmonyLink::kMaxNotes;
+    if (harmony.chord == kNoChord || numNotes == 0)
+        return 0;
+
+    // Distinct pitch classes, counted upwards from the bass
+    const int bass = harmony.notes[0] % 12;
+    uint16_t intervals = 0;
+    for (int i = 0; i < numNotes; ++i)
+        intervals |= static_cast<uint16_t>(1u << ((harmony.notes[static_cast<size_t>(i)] % 12 - bass + 12) % 12));
+
+    const int base = (octave + 1) * 12 + bass;
+    int count = 0;
+    for (int interval = 0; interval < 12; ++interval) {
+        if ((intervals & (1u << interval)) == 0)
+            continue;
+        const int note = base + interval;
+        if (note > 127)
+            break;
+        notes[static_cast<size_t>(count++)] = static_cast<uint8_t>(note);
+    }
+    return count;
+}
+
+} // namespace chordpumper
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "engine/ChordId.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Lets plugin instances in one process play together: one leader per link
+// group publishes the chord, voicing and key it is playing, and followers pick
+// them up on their next block.
+//
+// Each group is a seqlock. The leader makes the sequence odd, writes the
+// payload words and makes it even again; a reader retries while the sequence
+// is odd or moved under it. The payload words are relaxed atomics, so a torn
+// read is detected rather than undefined. Nothing blocks: a reader gives up
+// after a few attempts and keeps what it had, and leadership is a single CAS.
+class HarmonyLink {
+public:
+    static constexpr int kNumGroups = 8;
+    static constexpr int kMaxNotes = 8;
+
+    struct Harmony {
+        ChordId chord = kNoChord;  // kNoChord once the leader is silent
+        uint32_t key = 0;          // packKeyEstimate of the leader's key
+        uint8_t numNotes = 0;
+        std::array<uint8_t, kMaxNotes> notes{};  // the leader's lowest notes, ascending
+
+        bool operator==(const Harmony&) const = default;
+    };
+
+    // One registry per process, shared by every instance.
+    static HarmonyLink& shared();
+
+    // A process-unique, non-zero id to claim leadership with.
+    uint32_t newInstanceId() { return nextInstanceId.fetch_add(1, std::memory_order_relaxed); }
+
+    // Makes the instance its group's leader unless another instance leads it.
+    bool claimLeadership(int group, uint32_t instanceId);
+
+    // Publishes silence and gives the group up, so followers do not keep
+    // holding the last chord. Does nothing unless the instance leads it.
+    void releaseLeadership(int group, uint32_t instanceId);
+
+    // Leader only: a group has a single writer.
+    void publish(int group, const Harmony& harmony);
+
+    // Copies the group's harmony if it changed since `version`, and updates
+    // `version`. Returns false if nothing new could be read.
+    bool read(int group, Harmony& harmony, uint32_t& version) const;
+
+private:
+    static constexpr int kPayloadWords = 4;
+    static constexpr int kMaxReadAttempts = 4;
+
+    struct alignas(64) Group {
+        std::atomic<uint32_t> leader{0};
+        std::atomic<uint32_t> sequence{0};
+        std::array<std::atomic<uint32_t>, kPayloadWords> payload{};
+    };
+
+    std::array<Group, kNumGroups> groups;
+    std::atomic<uint32_t> nextInstanceId{1};
+};
+
+// Re-voices a linked chord in close position from the given octave, keeping
+// the leader's bass pitch class at the bottom. Returns the number of notes.
+int revoiceInRegister(const HarmonyLink::Harmony& harmony, int octave,
+                      std::array<uint8_t, HarmonyLink::kMaxNotes>& notes);
+
+} // namespace chordpumper
@@ -1,4 +1,5 @@
 #include "midi/MidiFileBuilder.h"
+#include "engine/VoiceLeader.h"
 
 namespace chordpumper {
 
@@ -16,18 +17,22 @@ void MidiFileBuilder::buildSequence(juce::MidiMessageSequence& seq,
     seq.updateMatchedPairs();
 }
 
-bool MidiFileBuilder::writeToFile(const juce::MidiMessageSequence& seq,
-                                   const juce::File& file) {
+bool MidiFileBuilder::writeToStream(const juce::MidiMessageSequence& seq,
+                                     juce::OutputStream& stream) {
     juce::MidiFile midi;
     midi.setTicksPerQuarterNote(kTicksPerQuarterNote);
     midi.addTrack(seq);
+    return midi.writeTo(stream);
+}
 
+bool MidiFileBuilder::writeToFile(const juce::MidiMessageSequence& seq,
+                                   const juce::File& file) {
     file.deleteFile();
     auto stream = file.createOutputStream();
     if (stream == nullptr)
         return false;
 
-    bool ok = midi.writeTo(*stream);
+    bool ok = writeToStream(seq, *stream);
     stream->flush();
     stream.reset();
     return ok;
@@ -49,31 +54,84 @@ juce::File MidiFileBuilder::createMidiFile(const Chord& chord, int octave,
     return file;
 }
 
-bool MidiFileBuilder::exportProgression(const std::vector<Chord>& chords,
-                                        int octave, const juce::File& file,
-                                        float velocity) {
-    if (chords.empty())
-        return false;
+void MidiFileBuilder::buildProgression(juce::MidiMessageSequence& seq,
+                                       const std::vector<Chord>& chords, int octave,
+                                       const ExportOptions& options) {
+    const double bpm = options.bpm > 0.0 ? options.bpm : 120.0;
+    seq.addEvent(juce::MidiMessage::tempoMetaEvent(juce::roundToInt(60000000.0 / bpm)), 0.0);
+    seq.addEvent(juce::MidiMessage::timeSignatureMetaEvent(options.timeSigNumerator,
+                                                           options.timeSigDenominator), 0.0);
 
-    juce::MidiMessageSequence seq;
-    seq.addEvent(juce::MidiMessage::tempoMetaEvent(kTempoMicrosecondsPerBeat), 0.0);
+    const double barTicks = kTicksPerQuarterNote * 4.0 * options.timeSigNumerator
+                          / options.timeSigDenominator;
+    double startTick = 0.0;
+    std::vector<int> previous;
 
-    for (size_t i = 0; i < chords.size(); ++i)
+    for (const auto& chord : chords)
     {
-        double startTick = static_cast<double>(i * kBarLengthTicks);
-        double endTick = startTick + static_cast<double>(kBarLengthTicks);
+        const double lengthTicks = chord.lengthBeats > 0.0
+            ? chord.lengthBeats * kTicksPerQuarterNote
+            : barTicks;
+        const double endTick = startTick + lengthTicks;
+
+        // Voice-lead in the base octave; the chord's own octave shift is
+        // applied on top so it still moves the chord as it does in the strip.
+        std::vector<int> notes = options.voiceLead
+            ? optimalVoicing(chord, previous, octave).midiNotes
+            : chord.midiNotes(octave);
+        previous = notes;
+
+        if (options.writeMarkers)
+        {
+            juce::String label(chord.name());
+            if (!chord.romanNumeral.empty())
+                label << " (" << chord.romanNumeral << ")";
+            seq.addEvent(juce::MidiMessage::textMetaEvent(kMarkerMetaType, label), startTick);
+        }
 
-        for (int note : chords[i].midiNotes(octave))
+        // Like the strip's sequencer, notes the octave shift pushes out of
+        // MIDI range are left out rather than folded back in
+        for (int note : notes)
         {
-            seq.addEvent(juce::MidiMessage::noteOn(kChannel, note, velocity), startTick);
-            seq.addEvent(juce::MidiMessage::noteOff(kChannel, note, 0.0f), endTick);
+            int shifted = note + 12 * chord.octaveOffset;
+            if (shifted < 0 || shifted > 127)
+                continue;
+            seq.addEvent(juce::MidiMessage::noteOn(kChannel, shifted, options.velocity), startTick);
+            seq.addEvent(juce::MidiMessage::noteOff(kChannel, shifted, 0.0f), endTick);
         }
+        startTick = endTick;
     }
 
     seq.updateMatchedPairs();
+}
+
+bool MidiFileBuilder::exportProgression(const std::vector<Chord>& chords,
+                                        int octave, const juce::File& file,
+                                        const ExportOptions& options) {
+    if (chords.empty())
+        return false;
+
+    juce::MidiMessageSequence seq;
+    buildProgression(seq, chords, octave, options);
     return writeToFile(seq, file);
 }
 
+juce::MemoryBlock MidiFileBuilder::renderProgression(const std::vector<Chord>& chords,
+                                                     int octave,
+                                                     const ExportOptions& options) {
+    juce::MemoryBlock data;
+    if (chords.empty())
+        return data;
+
+    juce::MidiMessageSequence seq;
+    buildProgression(seq, chords, octave, options);
+    juce::MemoryOutputStream stream(data, false);
+    if (!writeToStream(seq, stream))
+        return {};
+    stream.flush();  // trims the block to what was written
+    return data;
+}
+
 juce::File MidiFileBuilder::exportToDirectory(const Chord& chord, int octave,
                                                const juce::File& directory,
                                                float velocity) {
@@ -9,24 +9,48 @@ namespace chordpumper {
 
 class MidiFileBuilder {
 public:
+    // How a progression is rendered. Tempo and meter normally come from the
+    // host so the clip lines up with the session when dropped into it.
+    struct ExportOptions {
+        double bpm = 120.0;
+        int timeSigNumerator = 4;
+        int timeSigDenominator = 4;
+        bool voiceLead = true;      // move each chord to the voicing nearest the previous one
+        bool writeMarkers = true;   // a marker per chord with its name and Roman numeral
+        float velocity = 0.8f;
+
+        bool operator==(const ExportOptions&) const = default;
+    };
+
     static juce::File createMidiFile(const Chord& chord, int octave,
                                       float velocity = 0.8f);
     static juce::File exportToDirectory(const Chord& chord, int octave,
                                          const juce::File& directory,
                                          float velocity = 0.8f);
     static bool exportProgression(const std::vector<Chord>& chords, int octave,
-                                   const juce::File& file, float velocity = 0.8f);
+                                   const juce::File& file,
+                                   const ExportOptions& options = {});
+    // The same .mid file contents, built in memory; empty for no chords.
+    static juce::MemoryBlock renderProgression(const std::vector<Chord>& chords, int octave,
+                                               const ExportOptions& options = {});
 
 private:
     static void buildSequence(juce::MidiMessageSequence& seq,
                                const Chord& chord, int octave, float velocity);
+    // Chords with no length last one bar of the given meter.
+    static void buildProgression(juce::MidiMessageSequence& seq,
+                                 const std::vector<Chord>& chords, int octave,
+                                 const ExportOptions& options);
     static bool writeToFile(const juce::MidiMessageSequence& seq,
                              const juce::File& file);
+    static bool writeToStream(const juce::MidiMessageSequence& seq,
+                               juce::OutputStream& stream);
 
     static constexpr int kTicksPerQuarterNote = 480;
     static constexpr int kBarLengthTicks = 1920;
     static constexpr int kChannel = 1;
     static constexpr int kTempoMicrosecondsPerBeat = 500000; // 120 BPM
+    static constexpr int kMarkerMetaType = 6;
 };
 
 } // namespace chordpumper
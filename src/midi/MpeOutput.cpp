@@ -0,0 +1,203 @@
+#include "midi/MpeOutput.h"
+#include <algorithm>
+#include <bit>
+
+namespace chordpumper {
+
+void MpeChannelAllocator::reset() {
+    freeHead = freeTail = busyHead = busyTail = kNone;
+    for (int slot = 0; slot < kNumMemberChannels; ++slot)
+        append(slot, freeHead, freeTail);
+    freeMask = (1u << kNumMemberChannels) - 1;
+    lastAllocated = kNumMemberChannels - 1;
+    numBusy = 0;
+    channelOfNote.fill(0);
+}
+
+void MpeChannelAllocator::unlink(int slot, int& head, int& tail) {
+    const int before = prev[static_cast<size_t>(slot)];
+    const int after = next[static_cast<size_t>(slot)];
+    (before == kNone ? head : next[static_cast<size_t>(before)]) = after;
+    (after == kNone ? tail : prev[static_cast<size_t>(after)]) = before;
+}
+
+void MpeChannelAllocator::append(int slot, int& head, int& tail) {
+    prev[static_cast<size_t>(slot)] = tail;
+    next[static_cast<size_t>(slot)] = kNone;
+    (tail == kNone ? head : next[static_cast<size_t>(tail)]) = slot;
+    tail = slot;
+}
+
+// Round robin takes the first free channel after the last one handed out;
+// least-recently-used takes the channel that has been silent longest, which
+// gives release tails on the other channels the most time to ring out.
+int MpeChannelAllocator::pickFree() const {
+    if (policy == Policy::LeastRecentlyUsed)
+        return freeHead;
+
+    const uint32_t above = freeMask & ~((2u << lastAllocated) - 1);
+    return std::countr_zero(above != 0 ? above : freeMask);
+}
+
+MpeChannelAllocator::Allocation MpeChannelAllocator::allocate(int note) {
+    int stolenNote = -1;
+    int slot;
+    if (const int existing = channelForNote(note); existing != 0) {
+        slot = existing - kFirstMemberChannel;
+        stolenNote = note;
+        unlink(slot, busyHead, busyTail);
+    } else if (freeMask != 0) {
+        slot = pickFree();
+        unlink(slot, freeHead, freeTail);
+        freeMask &= ~(1u << slot);
+        ++numBusy;
+    } else {
+        slot = busyHead;
+        stolenNote = noteOnSlot[static_cast<size_t>(slot)];
+        channelOfNote[static_cast<size_t>(stolenNote)] = 0;
+        unlink(slot, busyHead, busyTail);
+    }
+
+    append(slot, busyHead, busyTail);
+    noteOnSlot[static_cast<size_t>(slot)] = static_cast<uint8_t>(note);
+    channelOfNote[static_cast<size_t>(note)] = static_cast<uint8_t>(slot + kFirstMemberChannel);
+    lastAllocated = slot;
+    return {slot + kFirstMemberChannel, stolenNote};
+}
+
+int MpeChannelAllocator::release(int note) {
+    const int channel = channelForNote(note);
+    if (channel == 0)
+        return 0;
+
+    const int slot = channel - kFirstMemberChannel;
+    channelOfNote[static_cast<size_t>(note)] = 0;
+    unlink(slot, busyHead, busyTail);
+    append(slot, freeHead, freeTail);
+    freeMask |= 1u << slot;
+    --numBusy;
+    return channel;
+}
+
+void MpeOutput::prepare() {
+    allocator.reset();
+    passedThrough.reset();
+    current = {};
+    enabled = false;
+}
+
+// MPE Configuration Message for a lower zone, then the pitch bend range on
+// every member channel (RPN 0). Zero member channels removes the zone.
+void MpeOutput::sendZoneConfiguration(juce::MidiBuffer& output, int sampleOffset,
+                                      int numMemberChannels) const {
+    auto rpn = [&](int channel, int parameter, int value) {
+        output.addEvent(juce::MidiMessage::controllerEvent(channel, 101, 0), sampleOffset);
+        output.addEvent(juce::MidiMessage::controllerEvent(channel, 100, parameter), sampleOffset);
+        output.addEvent(juce::MidiMessage::controllerEvent(channel, 6, value), sampleOffset);
+        output.addEvent(juce::MidiMessage::controllerEvent(channel, 38, 0), sampleOffset);
+    };
+    rpn(kMasterChannel, 6, numMemberChannels);
+    for (int i = 0; i < numMemberChannels; ++i)
+        rpn(MpeChannelAllocator::kFirstMemberChannel + i, 0, kPitchBendRange);
+}
+
+void MpeOutput::handleNote(const juce::MidiMessage& message, int sampleOffset, juce::MidiBuffer& output) {
+    const int note = message.getNoteNumber();
+
+    // A note passed through before MPE was enabled and re-triggered since
+    // sounds on both its own channel and a voice channel, so release both.
+    if (message.isNoteOff()) {
+        if (const int channel = allocator.release(note); channel != 0)
+            output.addEvent(juce::MidiMessage::noteOff(channel, note, message.getFloatVelocity()), sampleOffset);
+        if (passedThrough[static_cast<size_t>(note)]) {
+            passedThrough[static_cast<size_t>(note)] = false;
+            output.addEvent(juce::MidiMessage::noteOff(passThroughChannel[static_cast<size_t>(note)], note,
+                                                       message.getFloatVelocity()),
+                            sampleOffset);
+        }
+        return;
+    }
+
+    if (!enabled) {
+        passedThrough[static_cast<size_t>(note)] = true;
+        passThroughChannel[static_cast<size_t>(note)] = static_cast<uint8_t>(message.getChannel());
+        output.addEvent(message, sampleOffset);
+        return;
+    }
+
+    const auto allocation = allocator.allocate(note);
+    const int channel = allocation.channel;
+    if (allocation.stolenNote >= 0)
+        output.addEvent(juce::MidiMessage::noteOff(channel, allocation.stolenNote), sampleOffset);
+
+    // A member channel's expression must be set before its note starts
+    output.addEvent(juce::MidiMessage::pitchWheel(channel, current.pitchBend), sampleOffset);
+    output.addEvent(juce::MidiMessage::controllerEvent(channel, kTimbreController, current.timbre), sampleOffset);
+    output.addEvent(juce::MidiMessage::channelPressureChange(channel, current.pressure), sampleOffset);
+    output.addEvent(juce::MidiMessage::noteOn(channel, note, message.getFloatVelocity()), sampleOffset);
+}
+
+void MpeOutput::handleExpression(const juce::MidiMessage& message, int sampleOffset, juce::MidiBuffer& output) {
+    if (message.isAftertouch()) {
+        // Pressure on a key the chord also plays goes to that voice alone
+        const int value = message.getAfterTouchValue();
+        if (const int channel = allocator.channelForNote(message.getNoteNumber()); channel != 0) {
+            output.addEvent(juce::MidiMessage::channelPressureChange(channel, value), sampleOffset);
+            return;
+        }
+        current.pressure = value;
+    } else if (message.isChannelPressure()) {
+        current.pressure = message.getChannelPressureValue();
+    } else if (message.isPitchWheel()) {
+        current.pitchBend = message.getPitchWheelValue();
+    } else if (message.isControllerOfType(kTimbreController)) {
+        current.timbre = message.getControllerValue();
+    } else {
+        return;
+    }
+
+    allocator.forEachVoice([&](int channel, int) {
+        if (message.isPitchWheel())
+            output.addEvent(juce::MidiMessage::pitchWheel(channel, current.pitchBend), sampleOffset);
+        else if (message.isControllerOfType(kTimbreController))
+            output.addEvent(juce::MidiMessage::controllerEvent(channel, kTimbreController, current.timbre),
+                            sampleOffset);
+        else
+            output.addEvent(juce::MidiMessage::channelPressureChange(channel, current.pressure), sampleOffset);
+    });
+}
+
+void MpeOutput::process(const juce::MidiBuffer& notes, const juce::MidiBuffer& expression,
+                        int numSamples, juce::MidiBuffer& output) {
+    if (requestedEnabled != enabled) {
+        enabled = requestedEnabled;
+        sendZoneConfiguration(output, 0, enabled ? MpeChannelAllocator::kNumMemberChannels : 0);
+    }
+
+    auto note = notes.begin();
+    auto gesture = expression.begin();
+    const auto offsetOf = [numSamples](const juce::MidiMessageMetadata& metadata) {
+        return juce::jlimit(0, std::max(0, numSamples - 1), metadata.samplePosition);
+    };
+
+    while (note != notes.end() || gesture != expression.end()) {
+        const bool takeGesture = gesture != expression.end()
+            && (note == notes.end() || (*gesture).samplePosition <= (*note).samplePosition);
+        if (takeGesture) {
+            const auto metadata = *gesture;
+            ++gesture;
+            if (enabled)
+                handleExpression(metadata.getMessage(), offsetOf(metadata), output);
+        } else {
+            const auto metadata = *note;
+            ++note;
+            const auto message = metadata.getMessage();
+            if (message.isNoteOnOrOff())
+                handleNote(message, offsetOf(metadata), output);
+            else
+                output.addEvent(message, offsetOf(metadata));
+        }
+    }
+}
+
+} // namespace chordpumper
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Assigns sounding notes to the member channels of an MPE lower zone.
+//
+// Free and busy channels live in two intrusive lists (free ordered by
+// release time, busy by allocation time) plus a bitmask of free channels,
+// so allocating, releasing and stealing are all O(1) with fixed tables.
+// When every channel is busy the oldest voice is stolen.
+class MpeChannelAllocator {
+public:
+    enum class Policy { RoundRobin, LeastRecentlyUsed };
+
+    static constexpr int kFirstMemberChannel = 2;
+    static constexpr int kNumMemberChannels = 15;  // channels 2-16
+
+    struct Allocation {
+        int channel;
+        int stolenNote;  // note that must be released on channel first, or -1
+    };
+
+    MpeChannelAllocator() { reset(); }
+
+    void reset();
+    void setPolicy(Policy newPolicy) { policy = newPolicy; }
+
+    // A note that is already sounding is re-used and reported as stolen.
+    Allocation allocate(int note);
+
+    // Returns the channel the note was on, or 0 if it had none.
+    int release(int note);
+
+    int channelForNote(int note) const { return channelOfNote[static_cast<size_t>(note)]; }
+    int getNumVoices() const { return numBusy; }
+
+    // Calls fn(channel, note) for every sounding voice, oldest first.
+    template <typename Fn>
+    void forEachVoice(Fn&& fn) const {
+        for (int i = busyHead; i != kNone; i = next[static_cast<size_t>(i)])
+            fn(i + kFirstMemberChannel, static_cast<int>(noteOnSlot[static_cast<size_t>(i)]));
+    }
+
+private:
+    static constexpr int kNone = -1;
+
+    void unlink(int slot, int& head, int& tail);
+    void append(int slot, int& head, int& tail);
+    int pickFree() const;
+
+    Policy policy = Policy::LeastRecentlyUsed;
+    std::array<int, kNumMemberChannels> prev{};
+    std::array<int, kNumMemberChannels> next{};
+    int freeHead = kNone, freeTail = kNone;
+    int busyHead = kNone, busyTail = kNone;
+    uint32_t freeMask = 0;  // bit i set = slot i (channel i + 2) is free
+    int lastAllocated = kNumMemberChannels - 1;
+    int numBusy = 0;
+    std::array<uint8_t, kNumMemberChannels> noteOnSlot{};
+    std::array<uint8_t, 128> channelOfNote{};  // 0 = not sounding
+};
+
+// Output stage that spreads the plugin's notes across an MPE lower zone
+// and gives each voice its own pitch bend, pressure and timbre (CC74),
+// following the host's incoming expression. Incoming channel pressure and
+// polyphonic aftertouch both map onto the chord voices.
+//
+// When disabled notes pass through on their own channel and the zone is torn
+// down. Note-offs always follow their note-on, on every channel the note was
+// started on, so switching mode never leaves a note hanging.
+class MpeOutput {
+public:
+    static constexpr int kMasterChannel = 1;
+    static constexpr int kPitchBendRange = 2;  // semitones, so host bends pass through unscaled
+    static constexpr int kTimbreController = 74;
+
+    struct Expression {
+        int pitchBend = 8192;
+        int pressure = 0;
+        int timbre = 64;
+    };
+
+    void prepare();
+    void setEnabled(bool shouldBeEnabled) { requestedEnabled = shouldBeEnabled; }
+    void setPolicy(MpeChannelAllocator::Policy policy) { allocator.setPolicy(policy); }
+
+    // Audio thread: notes are the plugin's own output, expression the
+    // host's incoming pitch bend, pressure and CC74. Events on the same
+    // sample apply expression first, so new voices start with it.
+    void process(const juce::MidiBuffer& notes, const juce::MidiBuffer& expression,
+                 int numSamples, juce::MidiBuffer& output);
+
+    const MpeChannelAllocator& getAllocator() const { return allocator; }
+
+private:
+    void sendZoneConfiguration(juce::MidiBuffer& output, int sampleOffset, int numMemberChannels) const;
+    void handleNote(const juce::MidiMessage& message, int sampleOffset, juce::MidiBuffer& output);
+    void handleExpression(const juce::MidiMessage& message, int sampleOffset, juce::MidiBuffer& output);
+
+    MpeChannelAllocator allocator;
+    bool enabled = false;
+    bool requestedEnabled = false;
+    Expression current;
+    std::bitset<128> passedThrough;  // sounding notes sent on their own channel
+    std::array<uint8_t, 128> passThroughChannel{};
+};
+
+} // namespace chordpumper
@@ -0,0 +1,258 @@
+#include "midi/PerformanceEngine.h"
+#include <algorithm>
+#include <cmath>
+
+namespace chordpumper {
+
+void PerformanceEngine::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    blockStart = 0;
+    freeRunningPpq = 0.0;
+    numHeld = 0;
+    strumGroupSize = 0;
+    numPending = 0;
+    nextArpTick = -1;
+    sounding.fill(0);
+}
+
+int PerformanceEngine::getNumSounding() const {
+    return static_cast<int>(std::count_if(sounding.begin(), sounding.end(),
+                                          [](uint8_t channel) { return channel != 0; }));
+}
+
+void PerformanceEngine::emit(const Note& n, bool isNoteOn, int sampleOffset, juce::MidiBuffer& output) {
+    if (isNoteOn) {
+        output.addEvent(juce::MidiMessage::noteOn(n.channel, n.note, n.velocity), sampleOffset);
+        sounding[n.note] = n.channel;
+    } else {
+        output.addEvent(juce::MidiMessage::noteOff(n.channel, n.note), sampleOffset);
+        sounding[n.note] = 0;
+    }
+}
+
+// A note-on is only queued when its note-off will fit too, so a full pool
+// drops notes rather than leaving them hanging.
+void PerformanceEngine::schedule(int64_t time, const Note& n, bool isNoteOn) {
+    if (numPending + (isNoteOn ? 2 : 1) > kMaxPending)
+        return;
+    pending[static_cast<size_t>(numPending++)] = {time, n, isNoteOn};
+}
+
+void PerformanceEngine::allNotesOff(juce::MidiBuffer& output, int sampleOffset) {
+    for (int note = 0; note < 128; ++note)
+        if (sounding[static_cast<size_t>(note)] != 0)
+            emit({sounding[static_cast<size_t>(note)], static_cast<uint8_t>(note), 0.0f}, false,
+                 sampleOffset, output);
+    numHeld = 0;
+    strumGroupSize = 0;
+    numPending = 0;
+    nextArpTick = -1;
+}
+
+void PerformanceEngine::handleNoteOn(const Note& n, int sampleOffset, juce::MidiBuffer& output) {
+    switch (settings.mode) {
+    case Mode::Chord:
+        emit(n, true, sampleOffset, output);
+        break;
+    case Mode::Strum:
+        if (strumGroupSize == kMaxHeld)
+            flushStrum();
+        strumGroupOffset = sampleOffset;
+        strumGroup[static_cast<size_t>(strumGroupSize++)] = n;
+        break;
+    case Mode::Arpeggio:
+        for (int i = 0; i < numHeld; ++i)
+            if (held[static_cast<size_t>(i)].note == n.note)
+                return;
+        if (numHeld == kMaxHeld)
+            return;
+        if (numHeld == 0 && nextArpTick < 0)
+            arpStartOffset = sampleOffset;
+        held[static_cast<size_t>(numHeld++)] = n;
+        break;
+    }
+}
+
+void PerformanceEngine::handleNoteOff(const Note& n, int sampleOffset, juce::MidiBuffer& output) {
+    switch (settings.mode) {
+    case Mode::Chord:
+        emit(n, false, sampleOffset, output);
+        break;
+    case Mode::Strum:
+        schedule(blockStart + sampleOffset + strumDelay[n.note], n, false);
+        break;
+    case Mode::Arpeggio:
+        // Notes already played finish through their own scheduled note-offs
+        for (int i = 0; i < numHeld; ++i) {
+            if (held[static_cast<size_t>(i)].note == n.note) {
+                std::copy(held.begin() + i + 1, held.begin() + numHeld, held.begin() + i);
+                --numHeld;
+                break;
+            }
+        }
+        break;
+    }
+}
+
+void PerformanceEngine::flushStrum() {
+    if (strumGroupSize == 0)
+        return;
+
+    auto first = strumGroup.begin();
+    auto last = strumGroup.begin() + strumGroupSize;
+    std::sort(first, last, [](const Note& a, const Note& b) { return a.note < b.note; });
+
+    bool down = settings.strumDirection == StrumDirection::Down;
+    if (settings.strumDirection == StrumDirection::Alternate) {
+        down = strumDownNext;
+        strumDownNext = !strumDownNext;
+    }
+    if (down)
+        std::reverse(first, last);
+
+    const double spacing = settings.strumUnit == StrumUnit::Milliseconds
+        ? settings.strumAmount * sampleRate / 1000.0
+        : settings.strumAmount / kTicksPerQuarterNote * 60.0 * sampleRate / bpm;
+
+    for (int i = 0; i < strumGroupSize; ++i) {
+        const auto& n = strumGroup[static_cast<size_t>(i)];
+        const int delay = static_cast<int>(std::lround(i * std::max(0.0, spacing)));
+        strumDelay[n.note] = delay;
+        schedule(blockStart + strumGroupOffset + delay, n, true);
+    }
+    strumGroupSize = 0;
+}
+
+void PerformanceEngine::playArpStep(int sampleOffset, double tickSamples) {
+    std::array<Note, kMaxHeld> order = held;
+    const auto first = order.begin();
+    const auto last = order.begin() + numHeld;
+    if (settings.arpPattern != ArpPattern::AsPlayed)
+        std::sort(first, last, [](const Note& a, const Note& b) { return a.note < b.note; });
+
+    const int64_t n = numHeld;
+    int64_t index = arpStep % n;
+    if (settings.arpPattern == ArpPattern::Down) {
+        index = n - 1 - index;
+    } else if (settings.arpPattern == ArpPattern::UpDown) {
+        const int64_t period = std::max<int64_t>(1, 2 * n - 2);
+        const int64_t phase = arpStep % period;
+        index = phase < n ? phase : period - phase;
+    }
+
+    // Flooring keeps each note-off at or before the next hit, where note-offs
+    // are emitted first, so a repeated note is never cut by its own release.
+    const int gateSamples = std::max(1, static_cast<int>(std::floor(tickSamples * settings.arpGate)));
+    const int64_t time = blockStart + sampleOffset;
+    auto play = [&](const Note& note) {
+        schedule(time, note, true);
+        schedule(time + gateSamples, note, false);
+    };
+    if (settings.arpPattern == ArpPattern::Repeat)
+        std::for_each(first, last, play);
+    else
+        play(order[static_cast<size_t>(index)]);
+
+    if (++ratchetCount >= settings.ratchets) {
+        ratchetCount = 0;
+        ++arpStep;
+    }
+}
+
+// Hits fall on the host's grid (a free-running one while stopped). The
+// first hit after the player presses a chord sounds straight away rather
+// than waiting for the next grid line.
+void PerformanceEngine::runArpeggio(const StripSequencer::Transport& transport, int numSamples) {
+    const double ppqPerSample = bpm / (60.0 * sampleRate);
+    const double startPpq = transport.isPlaying ? transport.ppqPosition : freeRunningPpq;
+    freeRunningPpq = startPpq + numSamples * ppqPerSample;
+
+    if (numHeld == 0) {
+        nextArpTick = -1;
+        return;
+    }
+
+    const double tickLength = std::max(1.0e-3, settings.arpStepBeats / std::max(1, settings.ratchets));
+    const double tickSamples = tickLength / ppqPerSample;
+    const double offsetTolerance = StripSequencer::kOffsetTolerance;
+
+    if (nextArpTick < 0) {
+        arpStep = 0;
+        ratchetCount = 0;
+        playArpStep(arpStartOffset, tickSamples);
+        const double startedAt = startPpq + arpStartOffset * ppqPerSample;
+        nextArpTick = static_cast<int64_t>(std::floor(startedAt / tickLength + offsetTolerance)) + 1;
+    } else {
+        // Chase loops and jumps in the host transport
+        const double expected = nextArpTick * tickLength;
+        if (expected < startPpq - tickLength || expected > startPpq + 2.0 * tickLength)
+            nextArpTick = static_cast<int64_t>(std::ceil(startPpq / tickLength - offsetTolerance));
+    }
+
+    for (;;) {
+        const double offset = (nextArpTick * tickLength - startPpq) / ppqPerSample;
+        const int sampleOffset = std::max(0, static_cast<int>(std::ceil(offset - offsetTolerance)));
+        if (sampleOffset >= numSamples)
+            break;
+        playArpStep(sampleOffset, tickSamples);
+        ++nextArpTick;
+    }
+}
+
+// Due notes go out in time order, so a short gate that starts and ends in
+// one block leaves sounding[] matching the output. Note-offs go out before
+// note-ons due on the same sample, so one voice's release never swallows the
+// next hit of the same note.
+void PerformanceEngine::emitDue(int numSamples, juce::MidiBuffer& output) {
+    const int64_t blockEnd = blockStart + numSamples;
+    const auto first = pending.begin();
+    const auto last = first + numPending;
+    const auto due = std::partition(first, last, [blockEnd](const Pending& p) { return p.time < blockEnd; });
+    std::sort(first, due, [](const Pending& a, const Pending& b) {
+        return a.time != b.time ? a.time < b.time : !a.isNoteOn && b.isNoteOn;
+    });
+
+    for (auto p = first; p != due; ++p)
+        emit(p->note, p->isNoteOn, static_cast<int>(std::max<int64_t>(0, p->time - blockStart)), output);
+
+    std::move(due, last, first);
+    numPending = static_cast<int>(last - due);
+}
+
+void PerformanceEngine::process(const juce::MidiBuffer& input, const StripSequencer::Transport& transport,
+                                int numSamples, juce::MidiBuffer& output) {
+    if (numSamples <= 0)
+        return;
+
+    if (!(requested == settings)) {
+        if (requested.mode != settings.mode)
+            allNotesOff(output, 0);
+        settings = requested;
+    }
+    bpm = transport.bpm > 0.0 ? transport.bpm : 120.0;
+
+    for (const auto metadata : input) {
+        const auto message = metadata.getMessage();
+        const int sampleOffset = std::clamp(metadata.samplePosition, 0, numSamples - 1);
+        if (strumGroupSize > 0 && (sampleOffset != strumGroupOffset || !message.isNoteOn()))
+            flushStrum();
+
+        const Note n{static_cast<uint8_t>(message.getChannel()),
+                     static_cast<uint8_t>(message.getNoteNumber()), message.getFloatVelocity()};
+        if (message.isNoteOn())
+            handleNoteOn(n, sampleOffset, output);
+        else if (message.isNoteOff())
+            handleNoteOff(n, sampleOffset, output);
+        else
+            output.addEvent(message, sampleOffset);
+    }
+    flushStrum();
+
+    if (settings.mode == Mode::Arpeggio)
+        runArpeggio(transport, numSamples);
+
+    emitDue(numSamples, output);
+    blockStart += numSamples;
+}
+
+} // namespace chordpumper
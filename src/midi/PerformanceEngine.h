@@ -0,0 +1,106 @@
+#pragma once
+
+#include "midi/StripSequencer.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Output stage between the plugin's own notes (pads, strip, sequencer) and the
+// host: plays chords as-is, strummed, or arpeggiated on the host's beat grid,
+// with optional ratchets.
+//
+// Everything happens inside process(): delayed notes wait in a fixed pool,
+// held notes in a fixed array, so nothing allocates or locks. Output events
+// land at exact sample offsets; a strum or gate that crosses the block end is
+// emitted in a later block.
+class PerformanceEngine {
+public:
+    enum class Mode { Chord, Strum, Arpeggio };
+    enum class StrumDirection { Up, Down, Alternate };
+    enum class StrumUnit { Milliseconds, Ticks };
+    enum class ArpPattern { Up, Down, UpDown, AsPlayed, Repeat };
+
+    struct Settings {
+        Mode mode = Mode::Chord;
+        double strumAmount = 30.0;  // between voices, in strumUnit
+        StrumUnit strumUnit = StrumUnit::Milliseconds;
+        StrumDirection strumDirection = StrumDirection::Up;
+        ArpPattern arpPattern = ArpPattern::Up;
+        double arpStepBeats = 0.25;  // quarter notes per step
+        double arpGate = 0.8;        // fraction of each (ratcheted) step
+        int ratchets = 1;            // repeats per arpeggio step
+
+        bool operator==(const Settings&) const = default;
+    };
+
+    static constexpr int kMaxHeld = 16;
+    static constexpr int kMaxPending = 256;
+    static constexpr double kTicksPerQuarterNote = 480.0;
+
+    void prepare(double sampleRate);
+    void setSettings(const Settings& newSettings) { requested = newSettings; }
+
+    // Audio thread: turns this block's input notes into output notes.
+    void process(const juce::MidiBuffer& input, const StripSequencer::Transport& transport,
+                 int numSamples, juce::MidiBuffer& output);
+
+    // Audio thread: releases everything sounding and forgets held notes.
+    void allNotesOff(juce::MidiBuffer& output, int sampleOffset);
+
+    int getNumSounding() const;
+
+private:
+    struct Note {
+        uint8_t channel;
+        uint8_t note;
+        float velocity;
+    };
+
+    struct Pending {
+        int64_t time;  // absolute sample
+        Note note;
+        bool isNoteOn;
+    };
+
+    void handleNoteOn(const Note& n, int sampleOffset, juce::MidiBuffer& output);
+    void handleNoteOff(const Note& n, int sampleOffset, juce::MidiBuffer& output);
+    void flushStrum();
+    void runArpeggio(const StripSequencer::Transport& transport, int numSamples);
+    void playArpStep(int sampleOffset, double tickSamples);
+    void emitDue(int numSamples, juce::MidiBuffer& output);
+
+    void schedule(int64_t time, const Note& n, bool isNoteOn);
+    void emit(const Note& n, bool isNoteOn, int sampleOffset, juce::MidiBuffer& output);
+
+    double sampleRate = 44100.0;
+    Settings requested;
+    Settings settings;
+
+    int64_t blockStart = 0;  // absolute sample of the current block
+    double bpm = 120.0;
+    double freeRunningPpq = 0.0;  // arpeggio clock while the host is stopped
+
+    std::array<Note, kMaxHeld> held{};  // in the order they were played
+    int numHeld = 0;
+
+    // Note-ons that arrive on the same sample form one strum
+    std::array<Note, kMaxHeld> strumGroup{};
+    int strumGroupSize = 0;
+    int strumGroupOffset = 0;
+    bool strumDownNext = false;
+    std::array<int, 128> strumDelay{};  // samples; note-offs keep their note's offset
+
+    std::array<Pending, kMaxPending> pending{};
+    int numPending = 0;
+
+    int64_t nextArpTick = -1;  // grid index of the next (ratcheted) arpeggio hit; -1 = idle
+    int arpStartOffset = 0;
+    int64_t arpStep = 0;
+    int ratchetCount = 0;
+
+    std::array<uint8_t, 128> sounding{};  // output channel per note, 0 = silent
+};
+
+} // namespace chordpumper
@@ -0,0 +1,82 @@
+#include "midi/PerformanceRecorder.h"
+#include <cmath>
+
+namespace chordpumper {
+
+void PerformanceRecorder::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    held.reset();
+    lastChord = kNoChord;
+}
+
+void PerformanceRecorder::beginBlock(const StripSequencer::Transport& transport, int numSamples) {
+    ppqPerSample = transport.bpm / (60.0 * sampleRate);
+    blockPpq = transport.isPlaying ? transport.ppqPosition : freeRunningPpq;
+    freeRunningPpq = blockPpq + numSamples * ppqPerSample;
+
+    const bool isArmedNow = armed.load(std::memory_order_relaxed);
+    if (isArmedNow && !wasArmed) {
+        lastChord = kNoChord;  // a held chord is picked up at its next change
+    } else if (!isArmedNow && wasArmed && lastChord != kNoChord) {
+        lastChord = kNoChord;  // close the take's last chord where recording stopped
+        push({blockPpq, kNoChord, 0});
+    }
+    wasArmed = isArmedNow;
+}
+
+void PerformanceRecorder::noteOn(int note, int sampleOffset) {
+    held.noteOn(note);
+    if (!wasArmed)
+        return;
+
+    auto recognized = held.recognize();
+    if (recognized.isValid() && recognized.id != lastChord) {
+        lastChord = recognized.id;
+        push({ppqAt(sampleOffset), recognized.id, recognized.inversion});
+    }
+}
+
+void PerformanceRecorder::noteOff(int note, int sampleOffset) {
+    held.noteOff(note);
+    if (wasArmed && held.pitchClasses() == 0 && lastChord != kNoChord) {
+        lastChord = kNoChord;
+        push({ppqAt(sampleOffset), kNoChord, 0});
+    }
+}
+
+void PerformanceRecorder::allNotesOff(int sampleOffset) {
+    held.reset();
+    if (wasArmed && lastChord != kNoChord) {
+        lastChord = kNoChord;
+        push({ppqAt(sampleOffset), kNoChord, 0});
+    }
+}
+
+void PerformanceRecorder::push(const RecordedEvent& event) {
+    const auto scope = fifo.write(1);
+    if (scope.blockSize1 > 0)
+        events[static_cast<size_t>(scope.startIndex1)] = event;
+    else if (scope.blockSize2 > 0)
+        events[static_cast<size_t>(scope.startIndex2)] = event;
+    else
+        dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+double TakeBuilder::snap(double ppq) const {
+    return std::round(ppq / grid) * grid;
+}
+
+std::optional<Chord> TakeBuilder::add(const RecordedEvent& event) {
+    const double at = snap(event.ppq);
+    std::optional<Chord> completed;
+    if (openChord != kNoChord && at > openStart) {
+        completed = chordFromId(openChord);
+        completed->lengthBeats = at - openStart;
+    }
+
+    openChord = event.chord;
+    openStart = at;
+    return completed;
+}
+
+} // namespace chordpumper
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "engine/Chord.h"
+#include "engine/ChordRecognizer.h"
+#include "midi/StripSequencer.h"
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <optional>
+
+namespace chordpumper {
+
+// A chord change captured on the audio thread. chord == kNoChord marks the
+// moment every note was released.
+struct RecordedEvent {
+    double ppq;
+    ChordId chord;
+    uint8_t inversion;
+};
+
+// Captures the chords played into the plugin (MIDI input and pad clicks)
+// with sample-accurate PPQ timestamps, and hands them to the message thread
+// through a wait-free single-producer/single-consumer FIFO.
+//
+// Held notes are tracked whether or not recording is armed, so arming while
+// a chord is held records it from the next change on. Timestamps follow the
+// host's PPQ while its transport runs; otherwise a free-running clock at the
+// host tempo keeps takes usable with the transport stopped.
+class PerformanceRecorder {
+public:
+    static constexpr int kCapacity = 4096;
+
+    // Message thread
+    void setArmed(bool shouldRecord) { armed.store(shouldRecord, std::memory_order_relaxed); }
+    bool isArmed() const { return armed.load(std::memory_order_relaxed); }
+    int getNumDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    template <typename Fn>
+    void drain(Fn&& fn) {
+        const auto scope = fifo.read(fifo.getNumReady());
+        for (int i = scope.startIndex1; i < scope.startIndex1 + scope.blockSize1; ++i)
+            fn(events[static_cast<size_t>(i)]);
+        for (int i = scope.startIndex2; i < scope.startIndex2 + scope.blockSize2; ++i)
+            fn(events[static_cast<size_t>(i)]);
+    }
+
+    // Audio thread
+    void prepare(double sampleRate);
+    void beginBlock(const StripSequencer::Transport& transport, int numSamples);
+    void noteOn(int note, int sampleOffset);
+    void noteOff(int note, int sampleOffset);
+    void allNotesOff(int sampleOffset);
+
+private:
+    double ppqAt(int sampleOffset) const { return blockPpq + sampleOffset * ppqPerSample; }
+    void push(const RecordedEvent& event);
+
+    std::atomic<bool> armed{false};
+    std::atomic<int> dropped{0};
+    juce::AbstractFifo fifo{kCapacity};
+    std::array<RecordedEvent, kCapacity> events{};
+
+    // Audio thread only
+    ChordRecognizer held;
+    ChordId lastChord = kNoChord;
+    bool wasArmed = false;
+    double sampleRate = 44100.0;
+    double blockPpq = 0.0;
+    double ppqPerSample = 0.0;
+    double freeRunningPpq = 0.0;
+};
+
+// Message thread: turns recorded events into progression chords, one chord per
+// change, with start and end snapped to the nearest grid line of the host's
+// beat grid. A chord's length runs to the next change or release; chords that
+// collapse to zero length are dropped, and gaps between a release and the
+// next chord are not kept since the progression has no rests.
+class TakeBuilder {
+public:
+    explicit TakeBuilder(double gridBeats = 1.0) : grid(gridBeats) {}
+
+    // Returns the chord the event completes, if any.
+    std::optional<Chord> add(const RecordedEvent& event);
+
+    void reset() { openChord = kNoChord; }
+
+private:
+    double snap(double ppq) const;
+
+    double grid;
+    ChordId openChord = kNoChord;
+    double openStart = 0.0;
+};
+
+} // namespace chordpumper
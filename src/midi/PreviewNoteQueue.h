@@ -0,0 +1,55 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Wait-free single-producer/single-consumer hand-off of preview notes from the
+// message thread (pad and strip clicks) to processBlock.
+class PreviewNoteQueue {
+public:
+    struct Note {
+        uint8_t channel;
+        uint8_t note;
+        bool isNoteOn;
+        float velocity;
+    };
+
+    bool noteOn(int channel, int note, float velocity) {
+        return push({static_cast<uint8_t>(channel), static_cast<uint8_t>(note), true, velocity});
+    }
+
+    bool noteOff(int channel, int note) {
+        return push({static_cast<uint8_t>(channel), static_cast<uint8_t>(note), false, 0.0f});
+    }
+
+    // Audio thread: hands every queued note to fn in push order.
+    template <typename Fn>
+    void drain(Fn&& fn) {
+        const auto scope = fifo.read(fifo.getNumReady());
+        for (int i = scope.startIndex1; i < scope.startIndex1 + scope.blockSize1; ++i)
+            fn(notes[static_cast<size_t>(i)]);
+        for (int i = scope.startIndex2; i < scope.startIndex2 + scope.blockSize2; ++i)
+            fn(notes[static_cast<size_t>(i)]);
+    }
+
+private:
+    bool push(const Note& n) {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 > 0)
+            notes[static_cast<size_t>(scope.startIndex1)] = n;
+        else if (scope.blockSize2 > 0)
+            notes[static_cast<size_t>(scope.startIndex2)] = n;
+        else
+            return false;
+        return true;
+    }
+
+    static constexpr int kCapacity = 512;
+    juce::AbstractFifo fifo{kCapacity};
+    std::array<Note, kCapacity> notes{};
+};
+
+} // namespace chordpumper
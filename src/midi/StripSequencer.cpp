@@ -0,0 +1,132 @@
+#include "midi/StripSequencer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace chordpumper {
+
+SequenceSnapshot SequenceSnapshot::fromProgression(const std::vector<Chord>& progression,
+                                                   bool enabled) {
+    SequenceSnapshot snapshot;
+    snapshot.enabled = enabled;
+    snapshot.numSteps = static_cast<int>(std::min<size_t>(progression.size(), kMaxSteps));
+
+    for (int i = 0; i < snapshot.numSteps; ++i) {
+        const auto& chord = progression[static_cast<size_t>(i)];
+        auto& step = snapshot.steps[static_cast<size_t>(i)];
+        step.lengthBeats = chord.lengthBeats;
+        for (int note : chord.midiNotes(4 + chord.octaveOffset)) {
+            if (step.numNotes == kMaxNotes)
+                break;
+            if (note >= 0 && note < 128)
+                step.notes[static_cast<size_t>(step.numNotes++)] = static_cast<uint8_t>(note);
+        }
+    }
+    return snapshot;
+}
+
+void StripSequencer::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    numSounding = 0;
+    currentIndex = -1;
+}
+
+void StripSequencer::publish(const SequenceSnapshot& snapshot) {
+    snapshots.back() = snapshot;
+    snapshots.publish();
+}
+
+double StripSequencer::stepLength(int step) const {
+    double length = snapshots.front().steps[static_cast<size_t>(step)].lengthBeats;
+    return length > 0.0 ? length : quarterNotesPerBar;
+}
+
+StripSequencer::Position StripSequencer::positionAt(double ppq) const {
+    const auto& sequence = snapshots.front();
+    double loopLength = 0.0;
+    for (int i = 0; i < sequence.numSteps; ++i)
+        loopLength += stepLength(i);
+
+    const double loops = std::floor(ppq / loopLength);
+    double end = loops * loopLength;
+    for (int i = 0; i < sequence.numSteps; ++i) {
+        end += stepLength(i);
+        if (ppq < end || i == sequence.numSteps - 1)
+            return {static_cast<int64_t>(loops) * sequence.numSteps + i, i, end};
+    }
+    return {-1, 0, end};
+}
+
+StripSequencer::Position StripSequencer::following(const Position& p) const {
+    int next = (p.step + 1) % snapshots.front().numSteps;
+    return {p.index + 1, next, p.end + stepLength(next)};
+}
+
+bool StripSequencer::soundingMatches(int step) const {
+    const auto& s = snapshots.front().steps[static_cast<size_t>(step)];
+    return s.numNotes == numSounding
+        && std::equal(s.notes.begin(), s.notes.begin() + s.numNotes, sounding.begin());
+}
+
+void StripSequencer::stop(juce::MidiBuffer& midi, int sampleOffset) {
+    for (int i = 0; i < numSounding; ++i)
+        midi.addEvent(juce::MidiMessage::noteOff(kChannel, sounding[static_cast<size_t>(i)]),
+                      sampleOffset);
+    numSounding = 0;
+    currentIndex = -1;
+}
+
+void StripSequencer::trigger(int step, juce::MidiBuffer& midi, int sampleOffset) {
+    for (int i = 0; i < numSounding; ++i)
+        midi.addEvent(juce::MidiMessage::noteOff(kChannel, sounding[static_cast<size_t>(i)]),
+                      sampleOffset);
+
+    const auto& s = snapshots.front().steps[static_cast<size_t>(step)];
+    for (int i = 0; i < s.numNotes; ++i)
+        midi.addEvent(juce::MidiMessage::noteOn(kChannel, s.notes[static_cast<size_t>(i)], kVelocity),
+                      sampleOffset);
+    sounding = s.notes;
+    numSounding = s.numNotes;
+}
+
+void StripSequencer::process(const Transport& transport, int numSamples, juce::MidiBuffer& midi) {
+    if (snapshots.update())
+        sequenceChanged = true;
+
+    const auto& sequence = snapshots.front();
+    if (!transport.isPlaying || !sequence.enabled || sequence.numSteps == 0
+        || transport.bpm <= 0.0 || numSamples <= 0) {
+        if (numSounding > 0 || currentIndex >= 0)
+            stop(midi, 0);
+        return;
+    }
+
+    quarterNotesPerBar = transport.quarterNotesPerBar > 0.0 ? transport.quarterNotesPerBar : 4.0;
+    const double ppqPerSample = transport.bpm / (60.0 * sampleRate);
+    const double blockStart = transport.ppqPosition;
+
+    // Chase the step under the playhead: covers transport start, loops and
+    // jumps, and an edited sequence whose current step now holds other notes.
+    auto position = positionAt(blockStart);
+    const bool chase = sequenceChanged
+        ? currentIndex < 0 || !soundingMatches(position.step)
+        : position.index != currentIndex;
+    if (chase)
+        trigger(position.step, midi, 0);
+    currentIndex = position.index;
+    sequenceChanged = false;
+
+    // Each boundary lands on the first sample at or after it. The tolerance
+    // absorbs rounding in the host's PPQ so a boundary that falls exactly on
+    // a block edge is not played one sample early.
+    for (;;) {
+        const double offset = (position.end - blockStart) / ppqPerSample;
+        const int sampleOffset = std::max(0, static_cast<int>(std::ceil(offset - kOffsetTolerance)));
+        if (sampleOffset >= numSamples)
+            break;
+        position = following(position);
+        trigger(position.step, midi, sampleOffset);
+        currentIndex = position.index;
+    }
+}
+
+} // namespace chordpumper
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "engine/Chord.h"
+#include "midi/TripleBuffer.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace chordpumper {
+
+// Immutable description of what the sequencer plays, built on the message
+// thread and handed to the audio thread whole.
+struct SequenceSnapshot {
+    static constexpr int kMaxSteps = 64;
+    static constexpr int kMaxNotes = 8;
+
+    struct Step {
+        std::array<uint8_t, kMaxNotes> notes{};
+        int numNotes = 0;
+        double lengthBeats = 0.0;  // quarter notes; 0 = one bar of the host's meter
+    };
+
+    std::array<Step, kMaxSteps> steps{};
+    int numSteps = 0;
+    bool enabled = false;
+
+    // Uses the same voicing as the strip's preview (octave 4 plus each
+    // chord's octave offset) and each chord's length. Chords past kMaxSteps
+    // are ignored.
+    static SequenceSnapshot fromProgression(const std::vector<Chord>& progression, bool enabled);
+};
+
+// Plays the progression strip in time with the host transport.
+//
+// Every block the step sounding at the block's start position is derived from
+// the host's PPQ position, so starts, stops, loops and jumps are chased with
+// no extra state; step boundaries inside the block become note-offs and
+// note-ons at the exact sample offset for the block's tempo. Runs entirely
+// on the audio thread apart from publish().
+class StripSequencer {
+public:
+    struct Transport {
+        bool isPlaying = false;
+        double ppqPosition = 0.0;
+        double bpm = 120.0;
+        double quarterNotesPerBar = 4.0;
+    };
+
+    static constexpr int kChannel = 1;
+    static constexpr float kVelocity = 0.8f;
+    static constexpr double kOffsetTolerance = 1.0e-3;  // samples
+
+    void prepare(double sampleRate);
+
+    // Message thread: replaces the sequence. Calls must not overlap.
+    void publish(const SequenceSnapshot& snapshot);
+
+    // Audio thread: appends this block's events to midi.
+    void process(const Transport& transport, int numSamples, juce::MidiBuffer& midi);
+
+    // Audio thread: releases whatever is sounding at the given offset.
+    void stop(juce::MidiBuffer& midi, int sampleOffset);
+
+    bool isSounding() const { return numSounding > 0; }
+
+private:
+    struct Position {
+        int64_t index;  // absolute step count since PPQ 0, across loop repeats
+        int step;
+        double end;     // PPQ at which this step ends
+    };
+
+    Position positionAt(double ppq) const;
+    Position following(const Position& p) const;
+    double stepLength(int step) const;
+    bool soundingMatches(int step) const;
+    void trigger(int step, juce::MidiBuffer& midi, int sampleOffset);
+
+    TripleBuffer<SequenceSnapshot> snapshots;
+    double sampleRate = 44100.0;
+    double quarterNotesPerBar = 4.0;
+
+    std::array<uint8_t, SequenceSnapshot::kMaxNotes> sounding{};
+    int numSounding = 0;
+    int64_t currentIndex = -1;
+    bool sequenceChanged = false;
+};
+
+} // namespace chordpumper
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace chordpumper {
+
+// Wait-free single-writer/single-reader hand-off of the latest value.
+//
+// The writer fills the back slot and publish() swaps it with the shared
+// middle slot; the reader swaps the middle slot into its front slot only when
+// something new was published. Neither side ever blocks or sees a torn value,
+// and intermediate values the reader never picked up are simply overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer: the slot to fill before publish(). Contents are stale.
+    T& back() { return slots[writeIndex]; }
+
+    void publish() {
+        writeIndex = shared.exchange(static_cast<uint8_t>(writeIndex | kFresh),
+                                     std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader: picks up the latest published value, if any. Returns true when
+    // front() changed.
+    bool update() {
+        if ((shared.load(std::memory_order_relaxed) & kFresh) == 0)
+            return false;
+        readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    const T& front() const { return slots[readIndex]; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x03;
+    static constexpr uint8_t kFresh = 0x04;
+
+    std::array<T, 3> slots{};
+    std::atomic<uint8_t> shared{1};
+    uint8_t writeIndex = 0;  // writer only
+    uint8_t readIndex = 2;   // reader only
+};
+
+} // namespace chordpumper
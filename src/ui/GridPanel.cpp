@@ -1,68 +1,48 @@
 #include "GridPanel.h"
 #include "midi/ChromaticPalette.h"
+#include "engine/ChordTiers.h"
+#include "engine/RomanNumeral.h"
+#include "diagnostics/Trace.h"
 
 namespace chordpumper {
 
-namespace {
-
-std::array<Chord, 4> makeSubChords(PitchClass root,
-                                    ChordType tl, ChordType tr,
-                                    ChordType bl, ChordType br)
-{
-    return { Chord{root, tl}, Chord{root, tr}, Chord{root, bl}, Chord{root, br} };
-}
-
-void applySubVariations(PadComponent& pad, const Chord& chord)
-{
-    switch (chord.type)
-    {
-        case ChordType::Major:
-            pad.setSubVariations(true, makeSubChords(chord.root,
-                ChordType::Major, ChordType::Maj7, ChordType::Maj9, ChordType::Maj13));
-            break;
-        case ChordType::Minor:
-            pad.setSubVariations(true, makeSubChords(chord.root,
-                ChordType::Minor, ChordType::Min7, ChordType::Min9, ChordType::Min11));
-            break;
-        case ChordType::Maj7:
-            pad.setSubVariations(true, makeSubChords(chord.root,
-                ChordType::Maj7, ChordType::Maj9, ChordType::Maj11, ChordType::Maj13));
-            break;
-        case ChordType::Min7:
-            pad.setSubVariations(true, makeSubChords(chord.root,
-                ChordType::Min7, ChordType::Min9, ChordType::Min11, ChordType::Min13));
-            break;
-        case ChordType::Dom7:
-            pad.setSubVariations(true, makeSubChords(chord.root,
-                ChordType::Dom7, ChordType::Dom9, ChordType::Dom11, ChordType::Dom13));
-            break;
-        default:
-            pad.setSubVariations(false, {});
-            break;
-    }
-}
-
-} // anonymous namespace
-
-GridPanel::GridPanel(juce::MidiKeyboardState& ks,
+GridPanel::GridPanel(PreviewNoteQueue& queue,
                      PersistentState& state,
-                     juce::CriticalSection& lock)
-    : keyboardState(ks), persistentState(state), stateLock(lock)
+                     juce::CriticalSection& lock,
+                     PerfCounters& counters)
+    : previewQueue(queue), persistentState(state), stateLock(lock), perfCounters(counters)
 {
     {
         const juce::ScopedLock sl(stateLock);
         morphEngine.weights = persistentState.weights;
     }
 
-    for (int i = 0; i < 64; ++i)
+    refreshFromState();
+}
+
+// Adds or removes pads to match the layout; smaller grids own fewer pads.
+void GridPanel::layoutPads(GridSize size)
+{
+    if (size == gridSize)
+        return;
+
+    CHORDPUMPER_TRACE_SCOPE("GridPanel::layoutPads");
+    gridSize = size;
+    const int cells = size.cells();
+    while (pads.size() > cells)
+        pads.removeLast();
+    while (pads.size() < cells)
     {
-        auto* pad = pads.add(new PadComponent());
+        auto* pad = pads.add(new PadComponent(renderCache));
         pad->onPressStart = [this](const Chord& c) { startPreview(c); };
         pad->onPressEnd   = [this](const Chord&)   { stopPreview(); };
+        pad->onHover      = [this](const Chord& c) { prefetcher.prioritise(c); };
         addAndMakeVisible(pad);
     }
-
-    refreshFromState();
+    grid.resize(static_cast<size_t>(cells));
+    // Before the editor sizes the panel there is nothing to lay out
+    if (!getLocalBounds().isEmpty())
+        resized();
 }
 
 GridPanel::~GridPanel()
@@ -72,10 +52,14 @@ GridPanel::~GridPanel()
 
 void GridPanel::startPreview(const Chord& chord)
 {
+    CHORDPUMPER_TRACE_SCOPE("GridPanel::startPreview");
     releaseCurrentChord();
-    auto voiced = optimalVoicing(chord, activeNotes, defaultOctave + chord.octaveOffset);
+    auto voiced = [&] {
+        const PerfStat::ScopedTimer timer(perfCounters.voicing);
+        return optimalVoicing(chord, activeNotes, defaultOctave + chord.octaveOffset);
+    }();
     for (auto note : voiced.midiNotes)
-        keyboardState.noteOn(midiChannel, note, velocity);
+        previewQueue.noteOn(midiChannel, note, velocity);
     activeNotes.assign(voiced.midiNotes.begin(), voiced.midiNotes.end());
 }
 
@@ -86,92 +70,254 @@ void GridPanel::stopPreview()
 
 void GridPanel::morphTo(const Chord& chord)
 {
-    auto voiced = optimalVoicing(chord, activeNotes, defaultOctave);
-    auto suggestions = morphEngine.morph(chord, voiced.midiNotes);
-
-    for (int i = 0; i < 64; ++i)
+    CHORDPUMPER_TRACE_SCOPE("GridPanel::morphTo");
+    const auto count = grid.size();
+    auto result = morphCache.find(chord, activeNotes, defaultOctave, morphEngine.weights, count);
+    if (result == nullptr)
     {
-        const auto& suggestion = suggestions[static_cast<size_t>(i)];
-        pads[i]->setChord(suggestion.chord);
-        pads[i]->setRomanNumeral(suggestion.romanNumeral);
-        pads[i]->setScore(suggestion.score);
-        applySubVariations(*pads[i], suggestion.chord);
+        auto voiced = [&] {
+            const PerfStat::ScopedTimer timer(perfCounters.voicing);
+            return optimalVoicing(chord, activeNotes, defaultOctave);
+        }();
+        auto suggestions = [&] {
+            const PerfStat::ScopedTimer timer(perfCounters.morph);
+            return morphEngine.morph(chord, voiced.midiNotes, count);
+        }();
+        result = morphCache.insert(chord, activeNotes, defaultOctave, morphEngine.weights,
+                                   { std::move(voiced), std::move(suggestions) }, count);
     }
+    const auto& voiced = result->voiced;
+    const auto& suggestions = result->suggestions;
+
+    for (size_t i = 0; i < grid.size() && i < suggestions.size(); ++i)
+        grid[i] = { suggestions[i].chord, suggestions[i].romanNumeral, suggestions[i].score };
+    reference = chord;
+    showGrid();
 
     {
         const juce::ScopedLock sl(stateLock);
         persistentState.lastPlayedChord = chord;
         persistentState.lastVoicing.assign(voiced.midiNotes.begin(), voiced.midiNotes.end());
         persistentState.hasMorphed = true;
-        for (int i = 0; i < 64; ++i)
+        for (size_t i = 0; i < grid.size(); ++i)
+        {
+            persistentState.gridChords[i] = grid[i].chord;
+            persistentState.romanNumerals[i] = grid[i].romanNumeral;
+        }
+        persistentState.markDirty(PersistentState::kGridSection | PersistentState::kMorphContextSection);
+    }
+    schedulePrefetch();
+    repaint();
+}
+
+void GridPanel::setWeights(const MorphWeights& weights)
+{
+    if (weights == morphEngine.weights)
+        return;
+
+    CHORDPUMPER_TRACE_SCOPE("GridPanel::setWeights");
+    morphEngine.weights = weights;
+    {
+        const juce::ScopedLock sl(stateLock);
+        persistentState.weights = weights;
+        persistentState.markDirty(PersistentState::kWeightsSection);
+    }
+    rerank();
+    schedulePrefetch();
+}
+
+void GridPanel::setGridSize(GridSize size)
+{
+    if (size == gridSize)
+        return;
+
+    CHORDPUMPER_TRACE_SCOPE("GridPanel::setGridSize");
+    bool hasMorphed = false;
+    {
+        const juce::ScopedLock sl(stateLock);
+        persistentState.gridSize = size;
+        persistentState.markDirty(PersistentState::kGridSection);
+        hasMorphed = persistentState.hasMorphed;
+    }
+    layoutPads(size);
+
+    if (hasMorphed)
+    {
+        rerank();
+    }
+    else
+    {
+        auto palette = extendedChromaticPalette();
+        for (size_t i = 0; i < grid.size(); ++i)
+            grid[i] = { palette[i], {}, -1.0f };
+        showGrid();
+        repaint();
+    }
+    schedulePrefetch();
+}
+
+void GridPanel::showBank(int bank)
+{
+    CHORDPUMPER_TRACE_SCOPE("GridPanel::showBank");
+    releaseCurrentChord();
+    {
+        const juce::ScopedLock sl(stateLock);
+        persistentState.switchBank(bank);
+    }
+    refreshFromState();
+}
+
+// Scores the morphed grid again from its reference and voicing, e.g. for new
+// weights or a different number of pads. An unmorphed grid is left alone.
+void GridPanel::rerank()
+{
+    Chord lastPlayed{};
+    std::vector<int> lastVoicing;
+    {
+        const juce::ScopedLock sl(stateLock);
+        if (!persistentState.hasMorphed)
+            return;
+        lastPlayed = persistentState.lastPlayedChord;
+        lastVoicing = persistentState.lastVoicing;
+    }
+
+    auto suggestions = [&] {
+        const PerfStat::ScopedTimer timer(perfCounters.morph);
+        return morphEngine.morph(lastPlayed, lastVoicing, grid.size());
+    }();
+    for (size_t i = 0; i < grid.size() && i < suggestions.size(); ++i)
+        grid[i] = { suggestions[i].chord, suggestions[i].romanNumeral, suggestions[i].score };
+    {
+        const juce::ScopedLock sl(stateLock);
+        for (size_t i = 0; i < grid.size(); ++i)
         {
-            persistentState.gridChords[static_cast<size_t>(i)] = suggestions[static_cast<size_t>(i)].chord;
-            persistentState.romanNumerals[static_cast<size_t>(i)] = suggestions[static_cast<size_t>(i)].romanNumeral;
+            persistentState.gridChords[i] = grid[i].chord;
+            persistentState.romanNumerals[i] = grid[i].romanNumeral;
         }
+        persistentState.markDirty(PersistentState::kGridSection);
     }
+    showGrid();
     repaint();
 }
 
+void GridPanel::setComplexity(float complexity)
+{
+    const int level = complexityTier(complexity);
+    if (level == complexityLevel)
+        return;
+
+    complexityLevel = level;
+    showGrid();
+    repaint();
+}
+
+// Updates the pads without repainting them; callers repaint the grid once.
+// Complexity is a table lookup per pad, never a rescore. The quadrants follow
+// the lifted chord, so what a pad plays changes with the complexity too.
+void GridPanel::showGrid()
+{
+    for (size_t i = 0; i < grid.size(); ++i)
+    {
+        const auto& entry = grid[i];
+        const auto pad = padChordsAtTier(entry.chord, complexityLevel);
+
+        auto numeral = entry.romanNumeral;
+        if (pad.chord.type != entry.chord.type && reference && !numeral.empty())
+            numeral = romanNumeral(*reference, pad.chord);
+
+        pads[static_cast<int>(i)]->setDisplay(pad.chord, numeral, entry.score, pad.hasSubChords, pad.subChords);
+    }
+}
+
 void GridPanel::releaseCurrentChord()
 {
     for (auto note : activeNotes)
-        keyboardState.noteOff(midiChannel, note, 0.0f);
+        previewQueue.noteOff(midiChannel, note);
 
     activeNotes.clear();
 }
 
+// Queues the chords a user is likely to morph to next: every visible pad,
+// then the progression strip. Hovering a pad moves it to the front.
+void GridPanel::schedulePrefetch()
+{
+    std::vector<Chord> candidates;
+    candidates.reserve(static_cast<size_t>(pads.size()) + 8);
+    for (auto* pad : pads)
+        candidates.push_back(pad->getChord());
+    {
+        const juce::ScopedLock sl(stateLock);
+        candidates.insert(candidates.end(), persistentState.progression.begin(),
+                          persistentState.progression.end());
+    }
+    prefetcher.schedule(std::move(candidates), activeNotes, defaultOctave, morphEngine.weights, grid.size());
+}
+
 void GridPanel::refreshFromState()
 {
     const juce::ScopedLock sl(stateLock);
 
+    layoutPads(persistentState.gridSize);
     if (persistentState.hasMorphed)
     {
-        for (int i = 0; i < 64; ++i)
-        {
-            const auto& c = persistentState.gridChords[static_cast<size_t>(i)];
-            pads[i]->setChord(c);
-            pads[i]->setRomanNumeral(persistentState.romanNumerals[static_cast<size_t>(i)]);
-            pads[i]->setScore(-1.0f);
-            applySubVariations(*pads[i], c);
-        }
+        for (size_t i = 0; i < grid.size(); ++i)
+            grid[i] = { persistentState.gridChords[i], persistentState.romanNumerals[i], -1.0f };
+        reference = persistentState.lastPlayedChord;
         activeNotes = persistentState.lastVoicing;
     }
     else
     {
-        auto palette = chromaticPalette();
-        for (int i = 0; i < 64; ++i)
-        {
-            const auto& c = palette[static_cast<size_t>(i)];
-            pads[i]->setChord(c);
-            pads[i]->setRomanNumeral({});
-            pads[i]->setScore(-1.0f);
-            applySubVariations(*pads[i], c);
-        }
+        auto palette = extendedChromaticPalette();
+        for (size_t i = 0; i < grid.size(); ++i)
+            grid[i] = { palette[i], {}, -1.0f };
+        reference.reset();
         activeNotes.clear();
     }
 
-    morphEngine.weights = persistentState.weights;
+    // The weights are host parameters now; the editor pushes them through setWeights
+    showGrid();
+    triggerAsyncUpdate();
     repaint();
 }
 
+// Prefetching after a state load or editor open waits for the message loop,
+// so constructing the editor or restoring a session does not start morphing.
+void GridPanel::handleAsyncUpdate()
+{
+    schedulePrefetch();
+}
+
+// JUCE paints the pads between these two calls, so together they bracket the
+// cost of one grid repaint.
+void GridPanel::paint(juce::Graphics&)
+{
+    paintStart = std::chrono::steady_clock::now();
+}
+
+void GridPanel::paintOverChildren(juce::Graphics&)
+{
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - paintStart;
+    perfCounters.gridRepaint.add(elapsed.count());
+}
+
 void GridPanel::resized()
 {
-    juce::Grid grid;
-    grid.setGap(juce::Grid::Px(4));
+    juce::Grid layout;
+    layout.setGap(juce::Grid::Px(4));
 
     using Track = juce::Grid::TrackInfo;
     using Fr = juce::Grid::Fr;
 
-    for (int i = 0; i < 8; ++i)
-        grid.templateColumns.add(Track(Fr(1)));
+    for (int i = 0; i < gridSize.columns; ++i)
+        layout.templateColumns.add(Track(Fr(1)));
 
-    for (int i = 0; i < 8; ++i)
-        grid.templateRows.add(Track(Fr(1)));
+    for (int i = 0; i < gridSize.rows; ++i)
+        layout.templateRows.add(Track(Fr(1)));
 
     for (auto* pad : pads)
-        grid.items.add(juce::GridItem(*pad));
+        layout.items.add(juce::GridItem(*pad));
 
-    grid.performLayout(getLocalBounds());
+    layout.performLayout(getLocalBounds());
 }
 
 } // namespace chordpumper
@@ -3,37 +3,82 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "PadComponent.h"
+#include "PadRenderCache.h"
+#include "MorphPrefetcher.h"
 #include "../PersistentState.h"
 #include "engine/MorphEngine.h"
+#include "engine/MorphCache.h"
 #include "engine/VoiceLeader.h"
+#include "midi/PreviewNoteQueue.h"
+#include "diagnostics/PerfCounters.h"
 #include <functional>
+#include <optional>
 #include <vector>
 
 namespace chordpumper {
 
-class GridPanel : public juce::Component
+class GridPanel : public juce::Component,
+                  private juce::AsyncUpdater
 {
 public:
-    GridPanel(juce::MidiKeyboardState& keyboardState,
+    GridPanel(PreviewNoteQueue& previewQueue,
               PersistentState& state,
-              juce::CriticalSection& stateLock);
+              juce::CriticalSection& stateLock,
+              PerfCounters& perfCounters);
     ~GridPanel() override;
 
+    void paint(juce::Graphics& g) override;
+    void paintOverChildren(juce::Graphics& g) override;
     void resized() override;
     void refreshFromState();
     void morphTo(const Chord& chord);
 
+    // Re-ranks the current grid for new weights without moving its reference.
+    void setWeights(const MorphWeights& weights);
+
+    // 0..1, lifting every pad from its scored chord up to 13ths (ChordTiers.h).
+    void setComplexity(float complexity);
+
+    // Re-lays the pads and, if the grid has morphed, asks the engine for
+    // exactly as many suggestions as there are pads.
+    void setGridSize(GridSize size);
+
+    // Shows another bank on the same pads. A bank's roman numerals are only
+    // derived when it comes into view.
+    void showBank(int bank);
+
 private:
+    struct GridEntry
+    {
+        Chord chord;
+        std::string romanNumeral;
+        float score = -1.0f;
+    };
+
+    void layoutPads(GridSize size);
+    void rerank();
+    void showGrid();
     void startPreview(const Chord& chord);
     void stopPreview();
     void releaseCurrentChord();
+    void schedulePrefetch();
+    void handleAsyncUpdate() override;
 
-    juce::MidiKeyboardState& keyboardState;
+    PreviewNoteQueue& previewQueue;
     PersistentState& persistentState;
     juce::CriticalSection& stateLock;
+    PerfCounters& perfCounters;
+    std::chrono::steady_clock::time_point paintStart;
+    PadRenderCache renderCache;
     juce::OwnedArray<PadComponent> pads;
     std::vector<int> activeNotes;
+    GridSize gridSize{0, 0};
+    std::vector<GridEntry> grid;
+    std::optional<Chord> reference;
+    int complexityLevel = 0;
     MorphEngine morphEngine;
+    MorphCache morphCache;
+    MorphPrefetcher prefetcher{morphCache};
 
     float velocity = 0.8f;
     static constexpr int midiChannel = 1;
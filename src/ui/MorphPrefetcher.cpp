@@ -0,0 +1,106 @@
+#include "MorphPrefetcher.h"
+#include "diagnostics/Trace.h"
+#include "engine/TaskPool.h"
+#include <algorithm>
+
+namespace chordpumper {
+
+MorphPrefetcher::MorphPrefetcher(MorphCache& c)
+    : juce::Thread("Morph prefetch"), cache(c)
+{
+}
+
+MorphPrefetcher::~MorphPrefetcher()
+{
+    stopThread(2000);
+}
+
+void MorphPrefetcher::schedule(std::vector<Chord> candidates,
+                               std::vector<int> previousNotes,
+                               int octave,
+                               const MorphWeights& weights,
+                               size_t count)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        pending.assign(candidates.begin(), candidates.end());
+        contextNotes = std::move(previousNotes);
+        contextOctave = octave;
+        contextWeights = weights;
+        contextCount = count;
+    }
+    wake();
+}
+
+void MorphPrefetcher::prioritise(const Chord& chord)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        if (cache.contains(chord, contextNotes, contextOctave, contextWeights, contextCount))
+            return;
+
+        auto sameChord = [&chord](const Chord& c) { return c.root == chord.root && c.type == chord.type; };
+        pending.erase(std::remove_if(pending.begin(), pending.end(), sameChord), pending.end());
+        pending.push_front(chord);
+    }
+    wake();
+}
+
+// Message thread only, like the requests that call it
+void MorphPrefetcher::wake()
+{
+    if (isThreadRunning())
+        notify();
+    else
+        startThread(juce::Thread::Priority::background);
+}
+
+// Takes a few candidates from the front of the queue at a time (the hovered
+// pad is first) and computes them in parallel on the shared task pool.
+void MorphPrefetcher::run()
+{
+    Trace::setThreadName("Morph prefetch");
+    auto& pool = TaskPool::shared();
+    const size_t batchSize = static_cast<size_t>(pool.getNumThreads()) + 1;
+
+    while (!threadShouldExit())
+    {
+        std::vector<Chord> batch;
+        std::vector<int> notes;
+        int octave = 4;
+        size_t count = MorphEngine::kDefaultCount;
+        MorphEngine engine;
+        {
+            const juce::ScopedLock sl(lock);
+            if (pending.empty())
+            {
+                const juce::ScopedUnlock su(lock);
+                wait(-1);
+                continue;
+            }
+            const auto take = std::min(batchSize, pending.size());
+            batch.assign(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(take));
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(take));
+            notes = contextNotes;
+            octave = contextOctave;
+            count = contextCount;
+            engine.weights = contextWeights;
+        }
+
+        batch.erase(std::remove_if(batch.begin(), batch.end(),
+                                   [&](const Chord& c) { return cache.contains(c, notes, octave, engine.weights, count); }),
+                    batch.end());
+        if (batch.empty())
+            continue;
+
+        CHORDPUMPER_TRACE_SCOPE("MorphPrefetcher::compute");
+        pool.parallelFor(static_cast<int>(batch.size()), [&](int i) {
+            const auto& target = batch[static_cast<size_t>(i)];
+            cache.insert(target, notes, octave, engine.weights,
+                         MorphCache::compute(engine, target, notes, octave, count), count);
+        });
+    }
+    Trace::releaseThread();
+}
+
+} // namespace chordpumper
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/MorphCache.h"
+#include <juce_core/juce_core.h>
+#include <deque>
+#include <vector>
+
+namespace chordpumper {
+
+// Background-priority thread that fills a MorphCache with the morphs the user
+// is likely to ask for next, so the click path is a cache lookup. The
+// computation itself is spread over TaskPool::shared(). The thread starts with
+// the first request, so an editor that is opened and closed again (e.g. while
+// a host scans) never spawns it.
+class MorphPrefetcher : private juce::Thread
+{
+public:
+    explicit MorphPrefetcher(MorphCache& cache);
+    ~MorphPrefetcher() override;
+
+    // Replaces any pending work with the given candidates, computed in order
+    // against the voicing context, weights and grid size the next morph will use.
+    void schedule(std::vector<Chord> candidates,
+                  std::vector<int> previousNotes,
+                  int octave,
+                  const MorphWeights& weights,
+                  size_t count);
+
+    // Moves a candidate (e.g. the hovered pad) to the front of the queue.
+    void prioritise(const Chord& chord);
+
+private:
+    void run() override;
+    void wake();
+
+    MorphCache& cache;
+    juce::CriticalSection lock;
+    std::deque<Chord> pending;
+    std::vector<int> contextNotes;
+    int contextOctave = 4;
+    MorphWeights contextWeights;
+    size_t contextCount = MorphEngine::kDefaultCount;
+};
+
+} // namespace chordpumper
@@ -1,17 +1,42 @@
 #include "PadComponent.h"
 #include "ChordPumperLookAndFeel.h"
+#include "diagnostics/Trace.h"
+#include <cmath>
 
 namespace chordpumper {
 
+namespace {
+
+// Same layout as Graphics::drawText, kept so the glyphs can be reused
+void addTextLine(juce::GlyphArrangement& glyphs, const juce::Font& font, const juce::String& text,
+                 juce::Rectangle<int> area, juce::Justification justification)
+{
+    const int start = glyphs.getNumGlyphs();
+    glyphs.addCurtailedLineOfText(font, text, 0.0f, 0.0f, static_cast<float>(area.getWidth()), true);
+    glyphs.justifyGlyphs(start, glyphs.getNumGlyphs() - start,
+                         static_cast<float>(area.getX()), static_cast<float>(area.getY()),
+                         static_cast<float>(area.getWidth()), static_cast<float>(area.getHeight()),
+                         justification);
+}
+
+} // anonymous namespace
+
+PadComponent::PadComponent(PadRenderCache& cache)
+    : renderCache(cache)
+{
+}
+
 void PadComponent::setChord(const Chord& c)
 {
     chord = c;
+    textLayoutDirty = true;
     repaint();
 }
 
 void PadComponent::setRomanNumeral(const std::string& rn)
 {
     romanNumeral_ = rn;
+    textLayoutDirty = true;
     repaint();
 }
 
@@ -35,9 +60,21 @@ void PadComponent::setSubVariations(bool enabled, const std::array<Chord, 4>& ch
 {
     hasSubVariations = enabled;
     subChords = chords;
+    textLayoutDirty = true;
     repaint();
 }
 
+void PadComponent::setDisplay(const Chord& c, const std::string& rn, float score,
+                              bool subVariationsEnabled, const std::array<Chord, 4>& chords)
+{
+    chord = c;
+    romanNumeral_ = rn;
+    score_ = score;
+    hasSubVariations = subVariationsEnabled;
+    subChords = chords;
+    textLayoutDirty = true;
+}
+
 int PadComponent::quadrantAt(juce::Point<int> pos) const
 {
     if (!hasSubVariations) return -1;
@@ -46,93 +83,79 @@ int PadComponent::quadrantAt(juce::Point<int> pos) const
     return (bottom ? 2 : 0) + (right ? 1 : 0);  // TL=0, TR=1, BL=2, BR=3
 }
 
-void PadComponent::paint(juce::Graphics& g)
+juce::Colour PadComponent::accentColour() const
 {
-    auto bounds = getLocalBounds().toFloat().reduced(1.0f);
-    constexpr float cornerSize = 6.0f;
-
-    auto baseColour = isPressed ? juce::Colour(PadColours::pressed)
-                    : isHovered ? juce::Colour(PadColours::hovered)
-                                : juce::Colour(PadColours::background);
-    auto gradient = juce::ColourGradient::vertical(
-        baseColour.brighter(0.05f), baseColour.darker(0.05f), bounds);
-    g.setGradientFill(gradient);
-    g.fillRoundedRectangle(bounds, cornerSize);
-
-    // Quadrant separator lines
-    if (hasSubVariations)
-    {
-        g.setColour(juce::Colour(0x22ffffff));
-        // Vertical centre line
-        g.drawLine(bounds.getCentreX(), bounds.getY() + 4.0f,
-                   bounds.getCentreX(), bounds.getBottom() - 4.0f, 1.0f);
-        // Horizontal centre line
-        g.drawLine(bounds.getX() + 4.0f, bounds.getCentreY(),
-                   bounds.getRight() - 4.0f, bounds.getCentreY(), 1.0f);
-    }
-
-    float accentAlpha = isPressed ? 0.8f : isHovered ? 0.6f : 0.4f;
-    auto accentColour = (score_ >= 0.0f)
-        ? PadColours::similarityColour(score_)
-        : juce::Colour(PadColours::accentForType(chord.type));
-
-    // Glow rings (hover only) — painted BEFORE the solid border
-    if (isHovered)
-    {
-        g.setColour(accentColour.withAlpha(0.07f));
-        g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 9.0f);
-        g.setColour(accentColour.withAlpha(0.13f));
-        g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 6.0f);
-        g.setColour(accentColour.withAlpha(0.25f));
-        g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 4.0f);
-    }
-    // Solid border — always drawn, 3px
-    g.setColour(accentColour.withAlpha(accentAlpha));
-    g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 3.0f);
+    // Scores are quantised so that pads share a bounded set of cached backgrounds
+    if (score_ >= 0.0f)
+        return PadColours::similarityColour(std::round(score_ * 64.0f) / 64.0f);
+    return juce::Colour(PadColours::accentForType(chord.type));
+}
 
+void PadComponent::layoutText()
+{
+    primaryGlyphs.clear();
+    secondaryGlyphs.clear();
     auto textArea = getLocalBounds();
 
     if (hasSubVariations)
     {
-        g.setFont(juce::Font(juce::FontOptions(7.5f)));
-        constexpr juce::uint32 quadrantColour = 0xffcccccc;
-        g.setColour(juce::Colour(quadrantColour));
+        primaryTextColour = juce::Colour(0xffcccccc);
+        const juce::Font font(juce::FontOptions(7.5f));
         auto w = getWidth() / 2;
         auto h = getHeight() / 2;
-        // TL quadrant (index 0)
-        g.drawText(juce::String(subChords[0].name()),
-                   juce::Rectangle<int>(0, 0, w, h), juce::Justification::centred);
-        // TR quadrant (index 1)
-        g.drawText(juce::String(subChords[1].name()),
-                   juce::Rectangle<int>(w, 0, w, h), juce::Justification::centred);
-        // BL quadrant (index 2)
-        g.drawText(juce::String(subChords[2].name()),
-                   juce::Rectangle<int>(0, h, w, h), juce::Justification::centred);
-        // BR quadrant (index 3)
-        g.drawText(juce::String(subChords[3].name()),
-                   juce::Rectangle<int>(w, h, w, h), juce::Justification::centred);
+        // TL=0, TR=1, BL=2, BR=3
+        for (int q = 0; q < 4; ++q)
+            addTextLine(primaryGlyphs, font, juce::String(subChords[static_cast<size_t>(q)].name()),
+                        { (q % 2) * w, (q / 2) * h, w, h }, juce::Justification::centred);
     }
     else if (romanNumeral_.empty())
     {
-        g.setColour(juce::Colour(0xffe0e0e0));
-        g.setFont(juce::Font(juce::FontOptions(12.0f)));
-        g.drawText(juce::String(chord.name()), textArea,
-                   juce::Justification::centred);
+        primaryTextColour = juce::Colour(0xffe0e0e0);
+        addTextLine(primaryGlyphs, juce::Font(juce::FontOptions(12.0f)), juce::String(chord.name()),
+                    textArea, juce::Justification::centred);
     }
     else
     {
         auto topHalf = textArea.removeFromTop(textArea.getHeight() / 2);
         auto bottomHalf = textArea;
 
-        g.setColour(juce::Colour(0xffe0e0e0));
-        g.setFont(juce::Font(juce::FontOptions(11.0f)));
-        g.drawText(juce::String(chord.name()), topHalf,
-                   juce::Justification::centredBottom);
+        primaryTextColour = juce::Colour(0xffe0e0e0);
+        addTextLine(primaryGlyphs, juce::Font(juce::FontOptions(11.0f)), juce::String(chord.name()),
+                    topHalf, juce::Justification::centredBottom);
+        addTextLine(secondaryGlyphs, juce::Font(juce::FontOptions(9.0f)), juce::String(romanNumeral_),
+                    bottomHalf, juce::Justification::centredTop);
+    }
+
+    textLayoutDirty = false;
+}
+
+void PadComponent::resized()
+{
+    textLayoutDirty = true;
+}
 
+void PadComponent::paint(juce::Graphics& g)
+{
+    CHORDPUMPER_TRACE_SCOPE("PadComponent::paint");
+
+    const auto state = isPressed ? PadRenderCache::State::Pressed
+                     : isHovered ? PadRenderCache::State::Hovered
+                                 : PadRenderCache::State::Normal;
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto& background = renderCache.get({ state, hasSubVariations, accentColour().getARGB(),
+                                               getWidth(), getHeight(),
+                                               juce::roundToInt(scale * 100.0f) });
+    g.drawImage(background, getLocalBounds().toFloat());
+
+    if (textLayoutDirty)
+        layoutText();
+
+    g.setColour(primaryTextColour);
+    primaryGlyphs.draw(g);
+    if (secondaryGlyphs.getNumGlyphs() > 0)
+    {
         g.setColour(juce::Colour(0xffaaaaaa));
-        g.setFont(juce::Font(juce::FontOptions(9.0f)));
-        g.drawText(juce::String(romanNumeral_), bottomHalf,
-                   juce::Justification::centredTop);
+        secondaryGlyphs.draw(g);
     }
 }
 
@@ -229,6 +252,9 @@ void PadComponent::mouseEnter(const juce::MouseEvent&)
 {
     isHovered = true;
     repaint();
+
+    if (onHover)
+        onHover(chord);
 }
 
 void PadComponent::mouseExit(const juce::MouseEvent&)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/Chord.h"
+#include "PadRenderCache.h"
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <functional>
 #include <string>
@@ -11,6 +12,8 @@ namespace chordpumper {
 class PadComponent : public juce::Component
 {
 public:
+    explicit PadComponent(PadRenderCache& renderCache);
+
     void setChord(const Chord& c);
     void setRomanNumeral(const std::string& rn);
     void setScore(float s);
@@ -18,11 +21,18 @@ public:
     const Chord& getDragChord() const;
     void setSubVariations(bool enabled, const std::array<Chord, 4>& chords);
 
+    // Replaces everything the pad shows without repainting, so a caller
+    // updating many pads can issue a single repaint on their parent.
+    void setDisplay(const Chord& c, const std::string& rn, float score,
+                    bool subVariationsEnabled, const std::array<Chord, 4>& chords);
+
     std::function<void(const Chord&)> onClick;
     std::function<void(const Chord&)> onPressStart;
     std::function<void(const Chord&)> onPressEnd;
+    std::function<void(const Chord&)> onHover;
 
     void paint(juce::Graphics& g) override;
+    void resized() override;
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseDrag(const juce::MouseEvent& event) override;
     void mouseUp(const juce::MouseEvent& event) override;
@@ -44,6 +54,14 @@ private:
     int pendingOctaveOffset_ = 0;  // set on right-click mouseDown, used in mouseUp/mouseDrag
 
     int quadrantAt(juce::Point<int> pos) const;
+    juce::Colour accentColour() const;
+    void layoutText();
+
+    PadRenderCache& renderCache;
+    juce::GlyphArrangement primaryGlyphs;    // chord name, or the four quadrant names
+    juce::GlyphArrangement secondaryGlyphs;  // Roman numeral
+    juce::Colour primaryTextColour;
+    bool textLayoutDirty = true;
 };
 
 } // namespace chordpumper
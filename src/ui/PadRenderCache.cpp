@@ -0,0 +1,82 @@
+#include "PadRenderCache.h"
+#include "ChordPumperLookAndFeel.h"
+
+namespace chordpumper {
+
+size_t PadRenderCache::KeyHash::operator()(const Key& k) const noexcept
+{
+    auto h = static_cast<uint64_t>(k.accentArgb);
+    h = h * 31 + static_cast<uint64_t>(k.state) * 2 + (k.quadrantLines ? 1u : 0u);
+    h = h * 31 + static_cast<uint64_t>(k.width);
+    h = h * 31 + static_cast<uint64_t>(k.height);
+    h = h * 31 + static_cast<uint64_t>(k.scalePercent);
+    return static_cast<size_t>(h);
+}
+
+const juce::Image& PadRenderCache::get(const Key& key)
+{
+    if (auto it = images.find(key); it != images.end())
+        return it->second;
+
+    if (images.size() >= maxImages)
+        images.clear();
+
+    return images.emplace(key, render(key)).first->second;
+}
+
+juce::Image PadRenderCache::render(const Key& key)
+{
+    const float scale = static_cast<float>(key.scalePercent) / 100.0f;
+    juce::Image image(juce::Image::ARGB,
+                      juce::jmax(1, juce::roundToInt(static_cast<float>(key.width) * scale)),
+                      juce::jmax(1, juce::roundToInt(static_cast<float>(key.height) * scale)),
+                      true);
+
+    juce::Graphics g(image);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    auto bounds = juce::Rectangle<float>(0.0f, 0.0f, static_cast<float>(key.width),
+                                         static_cast<float>(key.height)).reduced(1.0f);
+    constexpr float cornerSize = 6.0f;
+    const bool isPressed = key.state == State::Pressed;
+    const bool isHovered = key.state == State::Hovered;
+
+    auto baseColour = isPressed ? juce::Colour(PadColours::pressed)
+                    : isHovered ? juce::Colour(PadColours::hovered)
+                                : juce::Colour(PadColours::background);
+    auto gradient = juce::ColourGradient::vertical(
+        baseColour.brighter(0.05f), baseColour.darker(0.05f), bounds);
+    g.setGradientFill(gradient);
+    g.fillRoundedRectangle(bounds, cornerSize);
+
+    // Quadrant separator lines
+    if (key.quadrantLines)
+    {
+        g.setColour(juce::Colour(0x22ffffff));
+        g.drawLine(bounds.getCentreX(), bounds.getY() + 4.0f,
+                   bounds.getCentreX(), bounds.getBottom() - 4.0f, 1.0f);
+        g.drawLine(bounds.getX() + 4.0f, bounds.getCentreY(),
+                   bounds.getRight() - 4.0f, bounds.getCentreY(), 1.0f);
+    }
+
+    float accentAlpha = isPressed ? 0.8f : isHovered ? 0.6f : 0.4f;
+    auto accentColour = juce::Colour(key.accentArgb);
+
+    // Glow rings (hover only) — painted BEFORE the solid border
+    if (isHovered)
+    {
+        g.setColour(accentColour.withAlpha(0.07f));
+        g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 9.0f);
+        g.setColour(accentColour.withAlpha(0.13f));
+        g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 6.0f);
+        g.setColour(accentColour.withAlpha(0.25f));
+        g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 4.0f);
+    }
+    // Solid border — always drawn, 3px
+    g.setColour(accentColour.withAlpha(accentAlpha));
+    g.drawRoundedRectangle(bounds.reduced(0.5f), cornerSize, 3.0f);
+
+    return image;
+}
+
+} // namespace chordpumper
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace chordpumper {
+
+// Pre-rendered pad backgrounds (gradient fill, quadrant lines, glow rings and
+// border) shared by every pad in a grid. Pads with the same size, state and
+// accent colour blit the same image instead of re-rasterising paths on each
+// repaint. Message thread only.
+class PadRenderCache
+{
+public:
+    enum class State : uint8_t { Normal, Hovered, Pressed };
+
+    struct Key
+    {
+        State state;
+        bool quadrantLines;
+        juce::uint32 accentArgb;
+        int width;
+        int height;
+        int scalePercent;  // physical pixels per logical pixel, x100
+
+        bool operator==(const Key&) const = default;
+    };
+
+    // Bounds memory; the working set of the largest (16x8) grid is well below this.
+    static constexpr size_t maxImages = 320;
+
+    const juce::Image& get(const Key& key);
+    void clear() { images.clear(); }
+    size_t size() const { return images.size(); }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const noexcept;
+    };
+
+    static juce::Image render(const Key& key);
+
+    std::unordered_map<Key, juce::Image, KeyHash> images;
+};
+
+} // namespace chordpumper
@@ -0,0 +1,66 @@
+#include "PerfOverlay.h"
+
+namespace chordpumper {
+
+namespace {
+
+juce::String formatRow(const char* label, const PerfStat::Snapshot& s, const char* unit, float scale)
+{
+    if (s.count == 0)
+        return juce::String(label) + "  --";
+
+    return juce::String(label)
+         + "  " + juce::String(s.last * scale, 2)
+         + " / " + juce::String(s.average * scale, 2)
+         + " / " + juce::String(s.max * scale, 2) + " " + unit;
+}
+
+} // anonymous namespace
+
+PerfOverlay::PerfOverlay(const PerfCounters& c)
+    : counters(c)
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void PerfOverlay::visibilityChanged()
+{
+    if (isVisible())
+        startTimerHz(4);
+    else
+        stopTimer();
+}
+
+void PerfOverlay::timerCallback()
+{
+    repaint();
+}
+
+void PerfOverlay::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+    g.setColour(juce::Colour(0xe0101018));
+    g.fillRoundedRectangle(bounds, 6.0f);
+    g.setColour(juce::Colour(0xff4a4a5a));
+    g.drawRoundedRectangle(bounds.reduced(0.5f), 6.0f, 1.0f);
+
+    const juce::String rows[] = {
+        "last / avg / max",
+        formatRow("Morph  ", counters.morph.read(), "ms", 1.0f),
+        formatRow("Voicing", counters.voicing.read(), "ms", 1.0f),
+        formatRow("Repaint", counters.gridRepaint.read(), "ms", 1.0f),
+        formatRow("Open   ", counters.editorOpen.read(), "ms", 1.0f),
+        formatRow("Audio  ", counters.audioLoad.read(), "%", 100.0f),
+    };
+
+    g.setFont(juce::Font(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 12.0f,
+                                           juce::Font::plain)));
+    auto area = getLocalBounds().reduced(8, 6);
+    for (size_t i = 0; i < std::size(rows); ++i)
+    {
+        g.setColour(i == 0 ? juce::Colour(0xff8888a0) : juce::Colour(0xffe0e0e0));
+        g.drawText(rows[i], area.removeFromTop(16), juce::Justification::centredLeft);
+    }
+}
+
+} // namespace chordpumper
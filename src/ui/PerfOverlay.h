@@ -0,0 +1,28 @@
+#pragma once
+
+#include "diagnostics/PerfCounters.h"
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace chordpumper {
+
+// Translucent readout of PerfCounters, refreshed a few times per second.
+// Ignores the mouse so the pads underneath stay playable.
+class PerfOverlay : public juce::Component,
+                    private juce::Timer
+{
+public:
+    explicit PerfOverlay(const PerfCounters& counters);
+
+    void paint(juce::Graphics& g) override;
+    void visibilityChanged() override;
+
+    static constexpr int preferredWidth = 250;
+    static constexpr int preferredHeight = 108;
+
+private:
+    void timerCallback() override;
+
+    const PerfCounters& counters;
+};
+
+} // namespace chordpumper
@@ -1,28 +1,90 @@
 #include "PluginEditor.h"
 #include "PadComponent.h"
 #include "midi/MidiFileBuilder.h"
+#include "diagnostics/Trace.h"
+#include "engine/ChordRecognizer.h"
+#include "engine/KeyDetector.h"
 #include "../PluginProcessor.h"
+#include <algorithm>
+#include <fstream>
 
 namespace chordpumper {
 
 ChordPumperEditor::ChordPumperEditor(ChordPumperProcessor& p)
     : AudioProcessorEditor(&p), processor(p),
-      gridPanel(p.getKeyboardState(), p.getState(), p.getStateLock()),
-      progressionStrip(p.getState(), p.getStateLock())
+      gridPanel(p.getPreviewQueue(), p.getState(), p.getStateLock(), p.getPerfCounters()),
+      progressionStrip(p.getState(), p.getStateLock()),
+      perfOverlay(p.getPerfCounters())
 {
     setLookAndFeel(&lookAndFeel);
     addAndMakeVisible(gridPanel);
     addAndMakeVisible(progressionStrip);
+    addChildComponent(perfOverlay);
+    addAndMakeVisible(followMidiButton);
+    followMidiButton.setTooltip("Morph the grid to chords played via MIDI or heard on the sidechain");
+    addAndMakeVisible(followKeyButton);
+    followKeyButton.setTooltip("Morph the grid to the tonic of the key being played");
+    addAndMakeVisible(syncButton);
+    syncButton.setTooltip("Play the progression one bar per chord while the host transport runs");
+    {
+        const juce::ScopedLock sl(p.getStateLock());
+        syncButton.setToggleState(p.getState().syncToHost, juce::dontSendNotification);
+    }
+    addAndMakeVisible(gridSizeBox);
+    gridSizeBox.setTooltip("Number of pads in the grid");
+    for (size_t i = 0; i < kGridSizes.size(); ++i)
+        gridSizeBox.addItem(juce::String(kGridSizes[i].columns) + " x " + juce::String(kGridSizes[i].rows),
+                            static_cast<int>(i) + 1);
+    {
+        const juce::ScopedLock sl(p.getStateLock());
+        selectGridSize(p.getState().gridSize);
+    }
+    gridSizeBox.onChange = [this]
+    {
+        if (auto index = gridSizeBox.getSelectedItemIndex(); index >= 0)
+            gridPanel.setGridSize(kGridSizes[static_cast<size_t>(index)]);
+    };
+    addAndMakeVisible(bankBox);
+    bankBox.setTooltip("Switch between independent grids");
+    for (int b = 0; b < kNumGridBanks; ++b)
+        bankBox.addItem("Bank " + juce::String::charToString(static_cast<juce::juce_wchar>('A' + b)), b + 1);
+    {
+        const juce::ScopedLock sl(p.getStateLock());
+        bankBox.setSelectedItemIndex(p.getState().activeBank, juce::dontSendNotification);
+    }
+    bankBox.onChange = [this]
+    {
+        if (auto index = bankBox.getSelectedItemIndex(); index >= 0)
+            gridPanel.showBank(index);
+    };
+    addAndMakeVisible(recordButton);
+    recordButton.setTooltip("Append chords played on the pads or via MIDI to the progression, "
+                            "snapped to the host's beat grid");
+    recordButton.onClick = [this]
+    {
+        if (recordButton.getToggleState())
+            takeBuilder.reset();
+        processor.getRecorder().setArmed(recordButton.getToggleState());
+    };
+    syncButton.onClick = [this]
+    {
+        {
+            const juce::ScopedLock sl(processor.getStateLock());
+            processor.getState().syncToHost = syncButton.getToggleState();
+            processor.getState().markDirty(PersistentState::kProgressionSection);
+        }
+        processor.publishSequence();
+    };
     progressionStrip.onPressStart = [this](const Chord& c) {
-        auto& ks = processor.getKeyboardState();
+        auto& queue = processor.getPreviewQueue();
         auto notes = c.midiNotes(4 + c.octaveOffset);
-        for (auto n : notes) ks.noteOn(1, n, 0.8f);
+        for (auto n : notes) queue.noteOn(1, n, 0.8f);
         stripActiveNotes = std::vector<int>(notes.begin(), notes.end());
     };
 
     progressionStrip.onPressEnd = [this](const Chord&) {
-        auto& ks = processor.getKeyboardState();
-        for (auto n : stripActiveNotes) ks.noteOff(1, n, 0.0f);
+        auto& queue = processor.getPreviewQueue();
+        for (auto n : stripActiveNotes) queue.noteOff(1, n);
         stripActiveNotes.clear();
     };
 
@@ -34,8 +96,22 @@ ChordPumperEditor::ChordPumperEditor(ChordPumperProcessor& p)
         gridPanel.morphTo(c);
     };
 
+    progressionStrip.onProgressionChanged = [this] { processor.publishSequence(); };
+    progressionStrip.getExportOptions = [this] { return processor.getExportOptions(); };
+
+    appliedWeights = processor.getMorphWeights();
+    gridPanel.setWeights(appliedWeights);
+    gridPanel.setComplexity(processor.getComplexity());
+
     processor.addChangeListener(this);
+    lastRecognizedChord = processor.getRecognizedChord();
+    lastDetectedKey = processor.getDetectedKey();
+    lastLinkedChord = processor.getLinkedChord();
+    startTimerHz(30);
     setSize(1000, 600);
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - openStart;
+    processor.getPerfCounters().editorOpen.add(elapsed.count());
 }
 
 ChordPumperEditor::~ChordPumperEditor()
@@ -48,6 +124,17 @@ void ChordPumperEditor::changeListenerCallback(juce::ChangeBroadcaster*)
 {
     gridPanel.refreshFromState();
     progressionStrip.refreshFromState();
+    const juce::ScopedLock sl(processor.getStateLock());
+    syncButton.setToggleState(processor.getState().syncToHost, juce::dontSendNotification);
+    selectGridSize(processor.getState().gridSize);
+    bankBox.setSelectedItemIndex(processor.getState().activeBank, juce::dontSendNotification);
+}
+
+void ChordPumperEditor::selectGridSize(GridSize size)
+{
+    auto it = std::find(kGridSizes.begin(), kGridSizes.end(), size);
+    if (it != kGridSizes.end())
+        gridSizeBox.setSelectedItemIndex(static_cast<int>(it - kGridSizes.begin()), juce::dontSendNotification);
 }
 
 void ChordPumperEditor::paint(juce::Graphics& g)
@@ -57,6 +144,20 @@ void ChordPumperEditor::paint(juce::Graphics& g)
     g.setFont(juce::Font(juce::FontOptions(20.0f)));
     g.drawText("ChordPumper", getLocalBounds().removeFromTop(40),
                juce::Justification::centred);
+    if (inputChordName.isNotEmpty())
+    {
+        g.setColour(juce::Colour(0xffaaaaaa));
+        g.setFont(juce::Font(juce::FontOptions(14.0f)));
+        g.drawText("Input: " + inputChordName, juce::Rectangle<int>(14, 0, 200, 40),
+                   juce::Justification::centredLeft);
+    }
+    if (inputKeyName.isNotEmpty())
+    {
+        g.setColour(juce::Colour(0xffaaaaaa));
+        g.setFont(juce::Font(juce::FontOptions(14.0f)));
+        g.drawText("Key: " + inputKeyName, juce::Rectangle<int>(214, 0, 160, 40),
+                   juce::Justification::centredLeft);
+    }
     g.setColour(juce::Colour(0xff4a4a5a).withAlpha(0.5f));
     g.drawHorizontalLine(40, 10.0f, static_cast<float>(getWidth() - 10));
 }
@@ -64,11 +165,158 @@ void ChordPumperEditor::paint(juce::Graphics& g)
 void ChordPumperEditor::resized()
 {
     auto area = getLocalBounds().reduced(10);
+    followMidiButton.setBounds(area.getRight() - 110, 8, 110, 24);
+    followKeyButton.setBounds(followMidiButton.getX() - 110, 8, 100, 24);
+    syncButton.setBounds(followKeyButton.getX() - 130, 8, 120, 24);
+    recordButton.setBounds(syncButton.getX() - 90, 8, 80, 24);
+    gridSizeBox.setBounds(recordButton.getX() - 80, 8, 70, 24);
+    bankBox.setBounds(gridSizeBox.getX() - 90, 8, 80, 24);
     area.removeFromTop(40);
     auto stripArea = area.removeFromBottom(50);
     area.removeFromBottom(6);
     gridPanel.setBounds(area);
     progressionStrip.setBounds(stripArea);
+    perfOverlay.setBounds(area.getRight() - PerfOverlay::preferredWidth - 6, area.getY() + 6,
+                          PerfOverlay::preferredWidth, PerfOverlay::preferredHeight);
+}
+
+// Polls the chord and key recognised on the audio thread and collects
+// recorded chords. Chord following waits until the chord has been stable for
+// two ticks so a strum morphs once. Weight automation re-ranks the grid at
+// most every kWeightsThrottleTicks, so a sweep updates steadily and its final
+// value always lands.
+void ChordPumperEditor::timerCallback()
+{
+    processor.flushClapParameterChanges();
+
+    // Drained even when not armed, so the release that closes a take arrives
+    processor.getRecorder().drain([this](const RecordedEvent& event)
+    {
+        if (auto chord = takeBuilder.add(event))
+            progressionStrip.addChord(*chord);
+    });
+
+    // Rebuilds the strip's drag MIDI only if the host tempo or meter moved
+    progressionStrip.updateDragData();
+
+    auto packed = processor.getRecognizedChord();
+    if (packed != lastRecognizedChord)
+    {
+        lastRecognizedChord = packed;
+        auto recognized = unpackRecognizedChord(packed);
+        if (recognized.isValid())
+        {
+            auto name = juce::String(chordFromId(recognized.id).name());
+            if (recognized.inversion > 0 && recognized.bass >= 0)
+                name << "/" << pitchClassFromSemitone(recognized.bass).name();
+            inputChordName = name;
+            repaint(0, 0, 214, 40);
+
+            pendingFollowChord = recognized.id;
+            followCountdown = 2;
+        }
+    }
+
+    auto packedKey = processor.getDetectedKey();
+    if (packedKey != lastDetectedKey)
+    {
+        lastDetectedKey = packedKey;
+        auto key = unpackKeyEstimate(packedKey);
+        if (key.isValid())
+        {
+            inputKeyName = juce::String(pitchClassFromSemitone(key.tonic).name())
+                         + " " + kModeNames[key.mode];
+            repaint(214, 0, 160, 40);
+
+            if (followKeyButton.getToggleState())
+            {
+                Chord tonic{pitchClassFromSemitone(key.tonic), kModePatterns[key.mode].triadQualities[0]};
+                lastFollowedChord = chordIdOf(tonic);
+                gridPanel.morphTo(tonic);
+            }
+        }
+    }
+
+    if (followCountdown > 0 && --followCountdown == 0)
+    {
+        if (followMidiButton.getToggleState() && pendingFollowChord != lastFollowedChord)
+        {
+            lastFollowedChord = pendingFollowChord;
+            gridPanel.morphTo(chordFromId(pendingFollowChord));
+        }
+    }
+
+    // A harmony link follower in Morph mode re-centres the grid on the leader's chord
+    auto packedLink = processor.getLinkedChord();
+    if (packedLink != lastLinkedChord)
+    {
+        lastLinkedChord = packedLink;
+        if (auto linked = unpackRecognizedChord(packedLink); linked.isValid())
+            gridPanel.morphTo(chordFromId(linked.id));
+    }
+
+    if (weightsCountdown == 0 && processor.getMorphWeights() != appliedWeights)
+        weightsCountdown = kWeightsThrottleTicks;
+
+    if (weightsCountdown > 0 && --weightsCountdown == 0)
+    {
+        appliedWeights = processor.getMorphWeights();
+        gridPanel.setWeights(appliedWeights);
+    }
+
+    gridPanel.setComplexity(processor.getComplexity());
+}
+
+// The header is full of controls, so the menu is only on the popup-menu
+// click (right-click, or ctrl-click on macOS)
+void ChordPumperEditor::mouseDown(const juce::MouseEvent& event)
+{
+    if (event.mods.isPopupMenu())
+        showDiagnosticsMenu();
+}
+
+void ChordPumperEditor::showDiagnosticsMenu()
+{
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Diagnostics");
+    menu.addItem("Record trace", true, Trace::isEnabled(), []
+    {
+        bool enable = !Trace::isEnabled();
+        if (enable)
+            Trace::setThreadName("Message");
+        Trace::setEnabled(enable);
+    });
+    menu.addItem("Save trace...", [this] { saveTrace(); });
+    menu.addItem("Clear trace", [] { Trace::clear(); });
+    menu.addSeparator();
+    menu.addItem("Performance overlay", true, perfOverlay.isVisible(), [this]
+    {
+        perfOverlay.setVisible(!perfOverlay.isVisible());
+    });
+    menu.addItem("Reset performance counters", [this] { processor.getPerfCounters().reset(); });
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this)
+                                                 .withMousePosition());
+}
+
+void ChordPumperEditor::saveTrace()
+{
+    traceChooser = std::make_unique<juce::FileChooser>(
+        "Save trace",
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+            .getChildFile("chordpumper-trace.json"),
+        "*.json");
+
+    traceChooser->launchAsync(
+        juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+            | juce::FileBrowserComponent::warnAboutOverwriting,
+        [](const juce::FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+            if (file == juce::File())
+                return;
+            std::ofstream out(file.getFullPathName().toStdString());
+            Trace::writeChromeJson(out);
+        });
 }
 
 bool ChordPumperEditor::shouldDropFilesWhenDraggedExternally(
@@ -76,6 +324,18 @@ bool ChordPumperEditor::shouldDropFilesWhenDraggedExternally(
     juce::StringArray& files,
     bool& canMoveFiles)
 {
+    if (details.description.toString() == ProgressionStrip::kDragDescription)
+    {
+        auto progressionFile = progressionStrip.takeDragFile();
+        if (progressionFile.existsAsFile())
+        {
+            files.add(progressionFile.getFullPathName());
+            canMoveFiles = false;
+            return true;
+        }
+        return false;
+    }
+
     if (auto* pad = dynamic_cast<PadComponent*>(details.sourceComponent.get()))
     {
         auto midiFile = MidiFileBuilder::createMidiFile(pad->getChord(), 4);
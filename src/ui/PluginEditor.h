@@ -3,7 +3,11 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "ChordPumperLookAndFeel.h"
 #include "GridPanel.h"
+#include "PerfOverlay.h"
 #include "ProgressionStrip.h"
+#include "engine/ChordId.h"
+#include "midi/PerformanceRecorder.h"
+#include <chrono>
 
 namespace chordpumper {
 
@@ -11,7 +15,8 @@ class ChordPumperProcessor;
 
 class ChordPumperEditor : public juce::AudioProcessorEditor,
                           public juce::DragAndDropContainer,
-                          public juce::ChangeListener
+                          public juce::ChangeListener,
+                          private juce::Timer
 {
 public:
     explicit ChordPumperEditor(ChordPumperProcessor& processor);
@@ -19,17 +24,45 @@ public:
 
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void mouseDown(const juce::MouseEvent& event) override;
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     bool shouldDropFilesWhenDraggedExternally(
         const juce::DragAndDropTarget::SourceDetails& details,
         juce::StringArray& files, bool& canMoveFiles) override;
 
 private:
+    void timerCallback() override;
+    void showDiagnosticsMenu();
+    void selectGridSize(GridSize size);
+    void saveTrace();
+
     ChordPumperProcessor& processor;
+    // Initialised before the other members so editorOpen covers building them
+    const std::chrono::steady_clock::time_point openStart = std::chrono::steady_clock::now();
     ChordPumperLookAndFeel lookAndFeel;
     GridPanel gridPanel;
     ProgressionStrip progressionStrip;
+    PerfOverlay perfOverlay;
+    juce::ToggleButton followMidiButton{"Follow input"};
+    juce::ToggleButton followKeyButton{"Follow key"};
+    juce::ToggleButton syncButton{"Play with host"};
+    juce::ToggleButton recordButton{"Record"};
+    juce::ComboBox gridSizeBox;
+    juce::ComboBox bankBox;
+    TakeBuilder takeBuilder;
+    juce::String inputChordName;
+    juce::String inputKeyName;
+    uint32_t lastRecognizedChord = 0;
+    uint32_t lastDetectedKey = 0;
+    uint32_t lastLinkedChord = 0;
+    ChordId pendingFollowChord = kNoChord;
+    ChordId lastFollowedChord = kNoChord;
+    int followCountdown = 0;
+    MorphWeights appliedWeights;
+    int weightsCountdown = 0;
+    static constexpr int kWeightsThrottleTicks = 4;
     std::vector<int> stripActiveNotes;
+    std::unique_ptr<juce::FileChooser> traceChooser;
 };
 
 } // namespace chordpumper
@@ -2,6 +2,7 @@
 #include "PadComponent.h"
 #include "ChordPumperLookAndFeel.h"
 #include "midi/MidiFileBuilder.h"
+#include <cmath>
 
 namespace chordpumper {
 
@@ -25,17 +26,23 @@ ProgressionStrip::ProgressionStrip(PersistentState& state, juce::CriticalSection
     exportButton.onClick = [this] { exportProgression(); };
 }
 
+ProgressionStrip::~ProgressionStrip()
+{
+    handedOffFile.deleteFile();
+}
+
 void ProgressionStrip::addChord(const Chord& chord)
 {
     if (chords.size() >= static_cast<size_t>(kMaxChords))
-        chords.erase(chords.begin());
+    {
+        refuseChord();
+        return;
+    }
 
     chords.push_back(chord);
+    scrollTo(static_cast<int>(chords.size()) - kVisibleSlots);
 
-    {
-        const juce::ScopedLock sl(stateLock);
-        persistentState.progression = chords;
-    }
+    storeProgression();
 
     updateClearButton();
     updateExportButton();
@@ -45,11 +52,9 @@ void ProgressionStrip::addChord(const Chord& chord)
 void ProgressionStrip::setChords(const std::vector<Chord>& newChords)
 {
     chords = newChords;
+    scrollTo(firstVisible);
 
-    {
-        const juce::ScopedLock sl(stateLock);
-        persistentState.progression = chords;
-    }
+    storeProgression();
 
     updateClearButton();
     updateExportButton();
@@ -59,11 +64,8 @@ void ProgressionStrip::setChords(const std::vector<Chord>& newChords)
 void ProgressionStrip::clear()
 {
     chords.clear();
-
-    {
-        const juce::ScopedLock sl(stateLock);
-        persistentState.progression.clear();
-    }
+    scrollTo(0);
+    storeProgression();
 
     updateClearButton();
     updateExportButton();
@@ -76,6 +78,9 @@ void ProgressionStrip::refreshFromState()
         const juce::ScopedLock sl(stateLock);
         chords = persistentState.progression;
     }
+    scrollTo(firstVisible);
+    dragDataDirty = true;
+    updateDragData();
     updateClearButton();
     updateExportButton();
     repaint();
@@ -114,10 +119,7 @@ void ProgressionStrip::itemDropped(const SourceDetails& details)
             // Swap the two slots
             std::swap(chords[static_cast<size_t>(fromIdx)],
                       chords[static_cast<size_t>(overwriteIndex)]);
-            {
-                const juce::ScopedLock sl(stateLock);
-                persistentState.progression = chords;
-            }
+            storeProgression();
             updateClearButton();
             updateExportButton();
         }
@@ -132,10 +134,7 @@ void ProgressionStrip::itemDropped(const SourceDetails& details)
                 toIdx--;
             chords.insert(chords.begin() + toIdx, chord);
 
-            {
-                const juce::ScopedLock sl(stateLock);
-                persistentState.progression = chords;
-            }
+            storeProgression();
             updateClearButton();
             updateExportButton();
         }
@@ -156,10 +155,7 @@ void ProgressionStrip::itemDropped(const SourceDetails& details)
         {
             // Overwrite in place
             chords[static_cast<size_t>(overwriteIndex)] = chord;
-            {
-                const juce::ScopedLock sl(stateLock);
-                persistentState.progression = chords;
-            }
+            storeProgression();
             updateClearButton();
             updateExportButton();
             if (onChordDropped)
@@ -169,13 +165,15 @@ void ProgressionStrip::itemDropped(const SourceDetails& details)
         {
             // Insert at insertionIndex
             if (chords.size() >= static_cast<size_t>(kMaxChords))
-                chords.erase(chords.begin());
-            int idx = juce::jlimit(0, static_cast<int>(chords.size()), insertionIndex);
-            chords.insert(chords.begin() + idx, chord);
             {
-                const juce::ScopedLock sl(stateLock);
-                persistentState.progression = chords;
+                refuseChord();
+                insertionIndex = -1;
+                isReceivingDrag = false;
+                return;
             }
+            int idx = juce::jlimit(0, static_cast<int>(chords.size()), insertionIndex);
+            chords.insert(chords.begin() + idx, chord);
+            storeProgression();
             updateClearButton();
             updateExportButton();
             if (onChordDropped)
@@ -214,15 +212,15 @@ void ProgressionStrip::itemDragExit(const SourceDetails& details)
 int ProgressionStrip::getChordIndexAtPosition(juce::Point<int> pos) const
 {
     auto area = getLocalBounds();
-    auto slotArea = area.removeFromLeft(area.getWidth() - 120);
+    auto slotArea = area.removeFromLeft(area.getWidth() - kButtonAreaWidth);
 
     if (!slotArea.contains(pos))
         return -1;
 
-    auto slotWidth = (slotArea.getWidth() - (kMaxChords - 1) * 4) / kMaxChords;
+    auto slotWidth = (slotArea.getWidth() - (kVisibleSlots - 1) * 4) / kVisibleSlots;
     int relX = pos.getX() - slotArea.getX();
     int cellWidth = slotWidth + 4;
-    int index = relX / cellWidth;
+    int index = firstVisible + relX / cellWidth;
     int posInCell = relX % cellWidth;
 
     if (posInCell >= slotWidth)
@@ -236,15 +234,15 @@ int ProgressionStrip::getChordIndexAtPosition(juce::Point<int> pos) const
 ProgressionStrip::SlotHit ProgressionStrip::slotAndGapAtX(int xPos) const
 {
     auto area = getLocalBounds();
-    auto slotArea = area.removeFromLeft(area.getWidth() - 120);
-    int slotWidth = (slotArea.getWidth() - (kMaxChords - 1) * 4) / kMaxChords;
+    auto slotArea = area.removeFromLeft(area.getWidth() - kButtonAreaWidth);
+    int slotWidth = (slotArea.getWidth() - (kVisibleSlots - 1) * 4) / kVisibleSlots;
     int cellWidth = slotWidth + 4;
     int relX = xPos - slotArea.getX();
     relX = juce::jlimit(0, slotArea.getWidth() - 1, relX);
     int cell = relX / cellWidth;
     int posInCell = relX % cellWidth;
     bool inGap = (posInCell >= slotWidth);
-    return { juce::jlimit(0, kMaxChords - 1, cell), inGap };
+    return { firstVisible + juce::jlimit(0, kVisibleSlots - 1, cell), inGap };
 }
 
 int ProgressionStrip::insertionIndexAtX(int xPos) const
@@ -256,6 +254,22 @@ int ProgressionStrip::insertionIndexAtX(int xPos) const
 
 void ProgressionStrip::mouseDrag(const juce::MouseEvent& event)
 {
+    if (dragHandlePressed)
+    {
+        if (event.getDistanceFromDragStart() < 6 || chords.empty())
+            return;
+        dragHandlePressed = false;
+
+        if (auto* container = juce::DragAndDropContainer::findParentDragContainerFor(this))
+        {
+            auto area = getLocalBounds();
+            auto slotArea = area.removeFromLeft(area.getWidth() - kButtonAreaWidth);
+            container->startDragging(juce::var(kDragDescription), this,
+                                     juce::ScaledImage(createComponentSnapshot(slotArea)), false);
+        }
+        return;
+    }
+
     // 10px threshold — wider than pad's 6px to avoid accidental reorder on click
     if (event.getDistanceFromDragStart() < 10)
         return;
@@ -275,8 +289,8 @@ void ProgressionStrip::mouseDrag(const juce::MouseEvent& event)
 
         // Build a drag image showing only the dragged slot, not the whole strip
         auto area = getLocalBounds();
-        auto slotArea = area.removeFromLeft(area.getWidth() - 120);
-        auto slotWidth = (slotArea.getWidth() - (kMaxChords - 1) * 4) / kMaxChords;
+        auto slotArea = area.removeFromLeft(area.getWidth() - kButtonAreaWidth);
+        auto slotWidth = (slotArea.getWidth() - (kVisibleSlots - 1) * 4) / kVisibleSlots;
         auto slotHeight = slotArea.getHeight();
 
         juce::Image dragImg(juce::Image::ARGB, slotWidth, slotHeight, true);
@@ -345,16 +359,20 @@ void ProgressionStrip::itemDragMove(const SourceDetails& details)
 
 void ProgressionStrip::mouseDown(const juce::MouseEvent& event)
 {
+    if (dragHandleBounds.contains(event.getPosition()))
+    {
+        dragHandlePressed = true;
+        return;
+    }
+
     if (event.mods.isPopupMenu())
     {
         int idx = getChordIndexAtPosition(event.getPosition());
         if (idx >= 0 && idx < static_cast<int>(chords.size()))
         {
             chords.erase(chords.begin() + idx);
-            {
-                const juce::ScopedLock sl(stateLock);
-                persistentState.progression = chords;
-            }
+            scrollTo(firstVisible);
+            storeProgression();
             updateClearButton();
             updateExportButton();
             repaint();
@@ -379,6 +397,7 @@ void ProgressionStrip::mouseDown(const juce::MouseEvent& event)
 
 void ProgressionStrip::mouseUp(const juce::MouseEvent& event)
 {
+    dragHandlePressed = false;
     int index = pressedIndex;
     pressedIndex = -1;
 
@@ -396,16 +415,17 @@ void ProgressionStrip::mouseUp(const juce::MouseEvent& event)
 void ProgressionStrip::paint(juce::Graphics& g)
 {
     auto area = getLocalBounds();
-    auto slotArea = area.removeFromLeft(area.getWidth() - 120);
+    auto slotArea = area.removeFromLeft(area.getWidth() - kButtonAreaWidth);
 
-    auto slotWidth = (slotArea.getWidth() - (kMaxChords - 1) * 4) / kMaxChords;
+    auto slotWidth = (slotArea.getWidth() - (kVisibleSlots - 1) * 4) / kVisibleSlots;
     auto font = juce::Font(juce::FontOptions(13.0f));
     g.setFont(font);
 
-    for (int i = 0; i < kMaxChords; ++i)
+    for (int slotIndex = 0; slotIndex < kVisibleSlots; ++slotIndex)
     {
-        auto x = slotArea.getX() + i * (slotWidth + 4);
+        auto x = slotArea.getX() + slotIndex * (slotWidth + 4);
         auto slot = juce::Rectangle<int>(x, slotArea.getY(), slotWidth, slotArea.getHeight());
+        const int i = firstVisible + slotIndex;
 
         if (static_cast<size_t>(i) < chords.size())
         {
@@ -466,14 +486,41 @@ void ProgressionStrip::paint(juce::Graphics& g)
     if (insertionIndex >= 0 && insertionIndex <= static_cast<int>(chords.size()))
     {
         auto area2 = getLocalBounds();
-        auto slotArea2 = area2.removeFromLeft(area2.getWidth() - 120);
-        auto slotWidth2 = (slotArea2.getWidth() - (kMaxChords - 1) * 4) / kMaxChords;
+        auto slotArea2 = area2.removeFromLeft(area2.getWidth() - kButtonAreaWidth);
+        auto slotWidth2 = (slotArea2.getWidth() - (kVisibleSlots - 1) * 4) / kVisibleSlots;
         int cellWidth2 = slotWidth2 + 4;
-        int cursorX = slotArea2.getX() + insertionIndex * cellWidth2 - 2;
+        int cursorX = slotArea2.getX() + (insertionIndex - firstVisible) * cellWidth2 - 2;
         g.setColour(juce::Colours::white);
         g.fillRect(cursorX, slotArea2.getY() + 2, 4, slotArea2.getHeight() - 4);
     }
 
+    // Chords scrolled out of view: a count at each edge that has more
+    const int hiddenBefore = firstVisible;
+    const int hiddenAfter = static_cast<int>(chords.size()) - firstVisible - kVisibleSlots;
+    g.setFont(juce::Font(juce::FontOptions(9.0f)));
+    g.setColour(juce::Colour(0xff88aaff));
+    if (hiddenBefore > 0)
+        g.drawText("<" + juce::String(hiddenBefore), slotArea.withWidth(24).withTrimmedTop(2),
+                   juce::Justification::centredTop);
+    if (hiddenAfter > 0)
+        g.drawText(juce::String(hiddenAfter) + ">", slotArea.withTrimmedLeft(slotArea.getWidth() - 24).withTrimmedTop(2),
+                   juce::Justification::centredTop);
+
+    // Full: say how many chords were refused instead of losing them quietly
+    if (refusedChords > 0)
+    {
+        g.setColour(juce::Colour(0xffe06060));
+        g.drawRoundedRectangle(slotArea.toFloat().reduced(0.5f), 4.0f, 1.5f);
+        g.drawText("Full: " + juce::String(refusedChords) + " not added",
+                   slotArea.withTrimmedBottom(2), juce::Justification::centredBottom);
+    }
+
+    // Drag handle: grip lines, dimmed while there is nothing to drag
+    g.setColour(juce::Colour(chords.empty() ? 0xff3a3a4a : 0xff8a8a9a));
+    auto grip = dragHandleBounds.toFloat().withSizeKeepingCentre(12.0f, 12.0f);
+    for (int i = 0; i < 3; ++i)
+        g.fillRect(grip.getX(), grip.getY() + 1.0f + i * 4.5f, grip.getWidth(), 1.5f);
+
     if (isReceivingDrag)
     {
         g.setColour(juce::Colour(0xff6c8ebf).withAlpha(0.15f));
@@ -489,6 +536,85 @@ void ProgressionStrip::resized()
     clearButton.setBounds(area.removeFromRight(56).reduced(0, 4));
     area.removeFromRight(4);
     exportButton.setBounds(area.removeFromRight(56).reduced(0, 4));
+    area.removeFromRight(4);
+    dragHandleBounds = area.removeFromRight(28).reduced(0, 4);
+}
+
+void ProgressionStrip::mouseMove(const juce::MouseEvent& event)
+{
+    bool overHandle = dragHandleBounds.contains(event.getPosition()) && !chords.empty();
+    setMouseCursor(overHandle ? juce::MouseCursor::DraggingHandCursor
+                              : juce::MouseCursor::NormalCursor);
+}
+
+void ProgressionStrip::mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel)
+{
+    const float delta = std::abs(wheel.deltaX) > std::abs(wheel.deltaY) ? -wheel.deltaX : wheel.deltaY;
+    if (delta == 0.0f || static_cast<int>(chords.size()) <= kVisibleSlots)
+    {
+        Component::mouseWheelMove(event, wheel);
+        return;
+    }
+    scrollTo(firstVisible + (delta < 0.0f ? 1 : -1));
+    repaint();
+}
+
+void ProgressionStrip::scrollTo(int firstChord)
+{
+    firstVisible = juce::jlimit(0, std::max(0, static_cast<int>(chords.size()) - kVisibleSlots), firstChord);
+}
+
+void ProgressionStrip::refuseChord()
+{
+    ++refusedChords;
+    repaint();
+}
+
+void ProgressionStrip::storeProgression()
+{
+    {
+        const juce::ScopedLock sl(stateLock);
+        persistentState.progression = chords;
+        persistentState.markDirty(PersistentState::kProgressionSection);
+    }
+    if (chords.size() < static_cast<size_t>(kMaxChords))
+        refusedChords = 0;
+    dragDataDirty = true;
+    updateDragData();
+    if (onProgressionChanged)
+        onProgressionChanged();
+}
+
+void ProgressionStrip::updateDragData()
+{
+    auto options = getExportOptions ? getExportOptions() : MidiFileBuilder::ExportOptions{};
+    if (!dragDataDirty && options == dragDataOptions)
+        return;
+
+    dragDataDirty = false;
+    dragDataOptions = options;
+    dragData = MidiFileBuilder::renderProgression(chords, 4, options);
+}
+
+juce::File ProgressionStrip::takeDragFile()
+{
+    // The previous drag's host has had the whole drag to read its file
+    handedOffFile.deleteFile();
+    handedOffFile = juce::File();
+
+    updateDragData();
+    if (dragData.isEmpty())
+        return {};
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getChildFile("chordpumper_progression_"
+                                  + juce::String::toHexString(juce::Random::getSystemRandom().nextInt64())
+                                  + ".mid");
+    if (!file.replaceWithData(dragData.getData(), dragData.getSize()))
+        return {};
+
+    handedOffFile = file;
+    return file;
 }
 
 void ProgressionStrip::updateClearButton()
@@ -516,11 +642,12 @@ void ProgressionStrip::exportProgression()
                         | juce::FileBrowserComponent::canSelectFiles
                         | juce::FileBrowserComponent::warnAboutOverwriting;
 
-    fileChooser->launchAsync(flags, [this](const juce::FileChooser& chooser) {
+    auto options = getExportOptions ? getExportOptions() : MidiFileBuilder::ExportOptions{};
+    fileChooser->launchAsync(flags, [this, options](const juce::FileChooser& chooser) {
         auto file = chooser.getResult();
         if (file == juce::File())
             return;
-        MidiFileBuilder::exportProgression(chords, 4, file);
+        MidiFileBuilder::exportProgression(chords, 4, file, options);
     });
 }
 
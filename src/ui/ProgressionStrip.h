@@ -2,6 +2,8 @@
 
 #include "engine/Chord.h"
 #include "../PersistentState.h"
+#include "midi/MidiFileBuilder.h"
+#include "midi/StripSequencer.h"
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <functional>
 #include <vector>
@@ -13,6 +15,7 @@ class ProgressionStrip : public juce::Component,
 {
 public:
     ProgressionStrip(PersistentState& state, juce::CriticalSection& stateLock);
+    ~ProgressionStrip() override;
 
     void addChord(const Chord& chord);
     void setChords(const std::vector<Chord>& newChords);
@@ -21,15 +24,28 @@ public:
     bool isEmpty() const;
     void refreshFromState();
 
+    // The progression as a .mid file for a drag out of the strip. The MIDI
+    // is rebuilt in memory whenever the chords or the export options change
+    // and only written to disk at drag start. The file is left for the host
+    // and deleted on the next drag or when the strip goes away.
+    juce::File takeDragFile();
+    void updateDragData();
+
+    static constexpr const char* kDragDescription = "PROGRESSION";
+
     std::function<void(const Chord&)> onChordClicked;
     std::function<void(const Chord&)> onChordDropped;
     std::function<void(const Chord&)> onPressStart;
     std::function<void(const Chord&)> onPressEnd;
+    std::function<void()> onProgressionChanged;
+    std::function<MidiFileBuilder::ExportOptions()> getExportOptions;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseUp(const juce::MouseEvent& event) override;
+    void mouseMove(const juce::MouseEvent& event) override;
+    void mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
 
     bool isInterestedInDragSource(const SourceDetails& details) override;
     void itemDropped(const SourceDetails& details) override;
@@ -38,12 +54,20 @@ public:
     void itemDragMove(const SourceDetails& details) override;
     void mouseDrag(const juce::MouseEvent& event) override;
 
-    static constexpr int kMaxChords = 8;
+    // The strip shows kVisibleSlots chords at a time and scrolls through the
+    // rest. Chords past kMaxChords are refused and counted, never dropped
+    // from the start of the progression.
+    static constexpr int kVisibleSlots = 8;
+    static constexpr int kMaxChords = SequenceSnapshot::kMaxSteps;
+    static constexpr int kButtonAreaWidth = 148;  // Clear, Export and the drag handle
 
 private:
+    void storeProgression();
     void updateClearButton();
     void updateExportButton();
     void exportProgression();
+    void refuseChord();
+    void scrollTo(int firstChord);
     int getChordIndexAtPosition(juce::Point<int> pos) const;
     int insertionIndexAtX(int xPos) const;
 
@@ -54,6 +78,10 @@ private:
     int insertionIndex = -1;
     int overwriteIndex = -1;
     int pressedIndex = -1;
+    int firstVisible = 0;  // index of the chord in the leftmost slot
+    int refusedChords = 0;  // added while the strip was full, shown until it has room
+    bool dragHandlePressed = false;
+    juce::Rectangle<int> dragHandleBounds;
 
     PersistentState& persistentState;
     juce::CriticalSection& stateLock;
@@ -62,6 +90,11 @@ private:
     juce::TextButton exportButton{"Export"};
     std::unique_ptr<juce::FileChooser> fileChooser;
     bool isReceivingDrag = false;
+
+    juce::MemoryBlock dragData;
+    MidiFileBuilder::ExportOptions dragDataOptions;
+    bool dragDataDirty = true;
+    juce::File handedOffFile;
 };
 
 } // namespace chordpumper
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include "engine/ChordRecognizer.h"
+#include "engine/PitchClassSet.h"
+#include <initializer_list>
+
+using namespace chordpumper;
+
+namespace {
+
+RecognizedChord play(std::initializer_list<int> notes) {
+    ChordRecognizer recognizer;
+    for (int n : notes)
+        recognizer.noteOn(n);
+    return recognizer.recognize();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Lookup table is built at compile time", "[chord_recognizer]") {
+    static_assert(kChordLookup[0x091] == makeChordId(0, ChordType::Major));
+    static_assert(kChordLookup[0] == kNoChord);
+    REQUIRE(kChordLookup.size() == 4096);
+}
+
+TEST_CASE("Every chord in kAllChords maps back to its own pitch-class set", "[chord_recognizer]") {
+    for (const auto& chord : kAllChords) {
+        auto set = pitchClassSet(chord);
+        ChordId id = kChordLookup[set];
+        REQUIRE(id != kNoChord);
+        REQUIRE(pitchClassSet(chordFromId(id)) == set);
+    }
+}
+
+TEST_CASE("Root position and inversions are identified from the bass", "[chord_recognizer]") {
+    auto root = play({60, 64, 67});
+    REQUIRE(root.id == makeChordId(0, ChordType::Major));
+    REQUIRE(root.inversion == 0);
+
+    auto first = play({52, 60, 67});
+    REQUIRE(first.id == makeChordId(0, ChordType::Major));
+    REQUIRE(first.inversion == 1);
+
+    auto third = play({48, 50, 53, 57});  // Dm7 over C
+    REQUIRE(third.id == makeChordId(2, ChordType::Min7));
+    REQUIRE(third.inversion == 3);
+}
+
+TEST_CASE("Seventh chords without a fifth are still recognised", "[chord_recognizer]") {
+    auto c7 = play({48, 52, 58});
+    REQUIRE(c7.id == makeChordId(0, ChordType::Dom7));
+}
+
+TEST_CASE("Symmetric chords are named from the bass", "[chord_recognizer]") {
+    auto dim = play({59, 62, 65, 68});
+    REQUIRE(dim.id == makeChordId(11, ChordType::Dim7));
+    REQUIRE(dim.inversion == 0);
+
+    auto aug = play({56, 60, 64});
+    REQUIRE(aug.id == makeChordId(8, ChordType::Augmented));
+}
+
+TEST_CASE("Held notes track duplicates and releases", "[chord_recognizer]") {
+    ChordRecognizer recognizer;
+    recognizer.noteOn(60);
+    recognizer.noteOn(64);
+    recognizer.noteOn(67);
+    recognizer.noteOn(72);  // doubled root
+    REQUIRE(recognizer.recognize().id == makeChordId(0, ChordType::Major));
+
+    recognizer.noteOff(60);
+    REQUIRE(recognizer.lowestNote() == 64);
+    REQUIRE(recognizer.recognize().id == makeChordId(0, ChordType::Major));
+    REQUIRE(recognizer.recognize().inversion == 1);
+
+    recognizer.noteOff(72);
+    REQUIRE(!recognizer.recognize().isValid());
+
+    recognizer.noteOff(99);  // never held
+    recognizer.reset();
+    REQUIRE(recognizer.pitchClasses() == 0);
+    REQUIRE(recognizer.lowestNote() == -1);
+}
+
+TEST_CASE("Recognition survives packing for atomic publication", "[chord_recognizer]") {
+    auto chord = play({52, 60, 67});
+    auto packed = packRecognizedChord(chord, 42);
+    REQUIRE(unpackRecognizedChord(packed) == chord);
+    REQUIRE(recognizedChordSerial(packed) == 42);
+}
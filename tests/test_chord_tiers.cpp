@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+#include "engine/ChordTiers.h"
+
+using namespace chordpumper;
+
+TEST_CASE("Complexity lifts triads through their family's extensions", "[chord_tiers]") {
+    REQUIRE(typeAtTier(ChordType::Major, 0) == ChordType::Major);
+    REQUIRE(typeAtTier(ChordType::Major, 1) == ChordType::Maj7);
+    REQUIRE(typeAtTier(ChordType::Major, 2) == ChordType::Maj9);
+    REQUIRE(typeAtTier(ChordType::Minor, 3) == ChordType::Min11);
+    REQUIRE(typeAtTier(ChordType::Minor, 4) == ChordType::Min13);
+    REQUIRE(typeAtTier(ChordType::Diminished, 1) == ChordType::HalfDim7);
+    REQUIRE(typeAtTier(ChordType::Augmented, 4) == ChordType::Augmented);
+}
+
+TEST_CASE("Complexity never strips extensions or changes a chord's family", "[chord_tiers]") {
+    for (int t = 0; t < 18; ++t) {
+        auto type = static_cast<ChordType>(t);
+        for (int tier = 0; tier < kNumComplexityTiers; ++tier) {
+            auto lifted = typeAtTier(type, tier);
+            REQUIRE(noteCount(lifted) >= noteCount(type));
+            REQUIRE(kIntervals[static_cast<size_t>(lifted)][1] == kIntervals[static_cast<size_t>(type)][1]);
+        }
+    }
+    REQUIRE(typeAtTier(ChordType::Dom7, 0) == ChordType::Dom7);
+    REQUIRE(typeAtTier(ChordType::Dom7, 3) == ChordType::Dom11);
+    REQUIRE(typeAtTier(ChordType::Maj13, 1) == ChordType::Maj13);
+}
+
+TEST_CASE("The complexity control spans every tier", "[chord_tiers]") {
+    REQUIRE(complexityTier(0.0f) == 0);
+    REQUIRE(complexityTier(0.25f) == 1);
+    REQUIRE(complexityTier(0.5f) == 2);
+    REQUIRE(complexityTier(1.0f) == 4);
+    REQUIRE(complexityTier(-1.0f) == 0);
+    REQUIRE(complexityTier(2.0f) == 4);
+}
+
+TEST_CASE("A pad's played chords follow the complexity", "[chord_tiers]") {
+    using namespace pitches;
+    const Chord g{G, ChordType::Major};
+
+    auto played = [](const PadChords& pad, int quadrant) {
+        const auto& chord = pad.hasSubChords && quadrant >= 0 ? pad.subChords[static_cast<size_t>(quadrant)] : pad.chord;
+        return chord.midiNotes(4);
+    };
+
+    // The pad and its lower quadrants play something else once lifted; the
+    // last quadrant is a 13th at either tier
+    const auto plain = padChordsAtTier(g, 0);
+    const auto sevenths = padChordsAtTier(g, 1);
+    for (int quadrant = -1; quadrant < 3; ++quadrant)
+        REQUIRE(played(plain, quadrant) != played(sevenths, quadrant));
+    REQUIRE(played(plain, 3) == played(sevenths, 3));
+
+    REQUIRE(plain.hasSubChords);
+    REQUIRE(plain.subChords[0].type == ChordType::Major);
+    REQUIRE(sevenths.chord.type == ChordType::Maj7);
+    REQUIRE(sevenths.subChords[0].type == ChordType::Maj7);
+    REQUIRE(sevenths.subChords[0].root == G);
+
+    // Ninths have no variations, so the whole pad plays the lifted chord
+    const auto ninths = padChordsAtTier(g, 2);
+    REQUIRE(!ninths.hasSubChords);
+    REQUIRE(ninths.chord.type == ChordType::Maj9);
+    REQUIRE(played(ninths, 0) == Chord{G, ChordType::Maj9}.midiNotes(4));
+}
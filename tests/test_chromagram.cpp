@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+#include "dsp/ChromagramAnalyzer.h"
+#include "engine/ChordRecognizer.h"
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+using namespace chordpumper;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr int kBlock = 64;
+
+struct Tone {
+    int note;
+    double level;
+};
+
+// Feeds one second of sines at the given MIDI notes and levels, in stereo.
+void feed(ChromagramAnalyzer& analyzer, const std::vector<Tone>& tones) {
+    std::vector<float> left(kBlock), right(kBlock);
+    const float* channels[] = {left.data(), right.data()};
+    long long sample = 0;
+    for (int block = 0; block < static_cast<int>(kRate) / kBlock; ++block) {
+        for (int i = 0; i < kBlock; ++i, ++sample) {
+            double t = static_cast<double>(sample) / kRate;
+            double value = 0.0;
+            for (const auto& tone : tones)
+                value += tone.level * std::sin(2.0 * 3.141592653589793 * 440.0 * std::exp2((tone.note - 69) / 12.0) * t);
+            left[static_cast<size_t>(i)] = right[static_cast<size_t>(i)] = static_cast<float>(value);
+        }
+        analyzer.process(channels, 2, kBlock);
+    }
+}
+
+// Equal-level sines.
+void feed(ChromagramAnalyzer& analyzer, std::initializer_list<int> notes) {
+    std::vector<Tone> tones;
+    for (int n : notes)
+        tones.push_back({n, 0.1});
+    feed(analyzer, tones);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Sine triad folds to its pitch classes", "[chromagram]") {
+    ChromagramAnalyzer analyzer;
+    analyzer.prepare(kRate, kBlock);
+    feed(analyzer, {48, 64, 67});
+
+    REQUIRE(analyzer.activePitchClasses() == ((1u << 0) | (1u << 4) | (1u << 7)));
+    REQUIRE(analyzer.bassPitchClass() == 0);
+
+    auto heard = ChordRecognizer::lookup(analyzer.activePitchClasses(), analyzer.bassPitchClass());
+    REQUIRE(heard.isValid());
+    REQUIRE(chordIdRoot(heard.id) == 0);
+    REQUIRE(chordIdType(heard.id) == ChordType::Major);
+    REQUIRE(heard.inversion == 0);
+}
+
+TEST_CASE("Bass note selects the inversion", "[chromagram]") {
+    ChromagramAnalyzer analyzer;
+    analyzer.prepare(kRate, kBlock);
+    feed(analyzer, {43, 60, 64});
+
+    auto heard = ChordRecognizer::lookup(analyzer.activePitchClasses(), analyzer.bassPitchClass());
+    REQUIRE(heard.isValid());
+    REQUIRE(chordIdRoot(heard.id) == 0);
+    REQUIRE(heard.inversion == 2);
+}
+
+TEST_CASE("Silence yields no pitch classes", "[chromagram]") {
+    ChromagramAnalyzer analyzer;
+    analyzer.prepare(kRate, kBlock);
+    feed(analyzer, {});
+
+    REQUIRE(analyzer.activePitchClasses() == 0);
+    REQUIRE(analyzer.bassPitchClass() == -1);
+}
+
+TEST_CASE("A bass that is not a chord tone does not root a symmetric chord", "[chromagram]") {
+    ChromagramAnalyzer analyzer;
+    analyzer.prepare(kRate, kBlock);
+    // E augmented above a quiet F2 that is too weak to count as a chord tone
+    feed(analyzer, {{41, 0.025}, {64, 0.1}, {68, 0.1}, {72, 0.1}});
+
+    REQUIRE(analyzer.activePitchClasses() == ((1u << 4) | (1u << 8) | (1u << 0)));
+    REQUIRE(analyzer.bassPitchClass() == 5);
+    REQUIRE(analyzer.chordBassPitchClass() == -1);
+
+    auto heard = ChordRecognizer::lookup(analyzer.activePitchClasses(), analyzer.chordBassPitchClass());
+    REQUIRE(heard.isValid());
+    REQUIRE(chordIdType(heard.id) == ChordType::Augmented);
+    REQUIRE(chordIdRoot(heard.id) != 5);
+}
@@ -0,0 +1,117 @@
+#include <catch2/catch_test_macros.hpp>
+#include "midi/ClapNoteBridge.h"
+#include "midi/MpeOutput.h"
+#include <cstring>
+#include <vector>
+
+using namespace chordpumper;
+
+namespace {
+
+// Collects whatever the bridge pushes, like a host's output queue
+struct OutputQueue {
+    std::vector<clap_event_note_t> notes;
+    std::vector<clap_event_note_expression_t> expressions;
+    int numMidi = 0;
+    clap_output_events_t events{this, &push};
+
+    static bool push(const clap_output_events_t* list, const clap_event_header_t* event) {
+        auto& queue = *static_cast<OutputQueue*>(list->ctx);
+        if (event->type == CLAP_EVENT_NOTE_ON || event->type == CLAP_EVENT_NOTE_OFF)
+            queue.notes.push_back(*reinterpret_cast<const clap_event_note_t*>(event));
+        else if (event->type == CLAP_EVENT_NOTE_EXPRESSION)
+            queue.expressions.push_back(*reinterpret_cast<const clap_event_note_expression_t*>(event));
+        else if (event->type == CLAP_EVENT_MIDI)
+            ++queue.numMidi;
+        return true;
+    }
+};
+
+clap_event_note_t clapNote(uint16_t type, int key, double velocity) {
+    clap_event_note_t note{};
+    note.header = {sizeof(note), 12, CLAP_CORE_EVENT_SPACE_ID, type, 0};
+    note.note_id = 7;
+    note.channel = 0;
+    note.key = static_cast<int16_t>(key);
+    note.velocity = velocity;
+    return note;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Incoming CLAP notes and expressions become MIDI messages", "[clap_note_bridge]") {
+    juce::MidiMessage message;
+
+    auto on = clapNote(CLAP_EVENT_NOTE_ON, 60, 0.5);
+    REQUIRE(ClapNoteBridge::toMidiMessage(on.header, message));
+    REQUIRE(message.isNoteOn());
+    REQUIRE(message.getNoteNumber() == 60);
+    REQUIRE(message.getChannel() == 1);
+
+    auto choke = clapNote(CLAP_EVENT_NOTE_CHOKE, 60, 0.0);
+    REQUIRE(ClapNoteBridge::toMidiMessage(choke.header, message));
+    REQUIRE(message.isNoteOff());
+
+    clap_event_note_expression_t pressure{};
+    pressure.header = {sizeof(pressure), 0, CLAP_CORE_EVENT_SPACE_ID, CLAP_EVENT_NOTE_EXPRESSION, 0};
+    pressure.expression_id = CLAP_NOTE_EXPRESSION_PRESSURE;
+    pressure.key = 64;
+    pressure.value = 1.0;
+    REQUIRE(ClapNoteBridge::toMidiMessage(pressure.header, message));
+    REQUIRE(message.isAftertouch());
+    REQUIRE(message.getAfterTouchValue() == 127);
+
+    clap_event_param_value_t param{};
+    param.header = {sizeof(param), 0, CLAP_CORE_EVENT_SPACE_ID, CLAP_EVENT_PARAM_VALUE, 0};
+    REQUIRE(!ClapNoteBridge::toMidiMessage(param.header, message));
+}
+
+TEST_CASE("Each output voice gets its own note ID", "[clap_note_bridge]") {
+    ClapNoteBridge bridge;
+    OutputQueue queue;
+
+    juce::MidiBuffer events;
+    for (int note : {60, 64, 67})
+        events.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 5);
+    events.addEvent(juce::MidiMessage::noteOff(1, 64), 100);
+    events.addEvent(juce::MidiMessage::noteOn(1, 64, 0.8f), 200);
+    bridge.write(events, queue.events);
+
+    REQUIRE(queue.notes.size() == 5);
+    REQUIRE(queue.notes[0].header.time == 5);
+    REQUIRE(queue.notes[0].note_id != queue.notes[1].note_id);
+    REQUIRE(queue.notes[1].note_id != queue.notes[2].note_id);
+    // The note-off carries its note's ID; the retrigger gets a new one
+    REQUIRE(queue.notes[3].header.type == CLAP_EVENT_NOTE_OFF);
+    REQUIRE(queue.notes[3].note_id == queue.notes[1].note_id);
+    REQUIRE(queue.notes[4].note_id != queue.notes[1].note_id);
+}
+
+TEST_CASE("MPE channel expression becomes per-note expression", "[clap_note_bridge]") {
+    ClapNoteBridge bridge;
+    OutputQueue queue;
+
+    // As MpeOutput sends a new voice: expression first, then the note
+    juce::MidiBuffer events;
+    events.addEvent(juce::MidiMessage::controllerEvent(3, MpeOutput::kTimbreController, 127), 0);
+    events.addEvent(juce::MidiMessage::noteOn(3, 62, 0.8f), 0);
+    events.addEvent(juce::MidiMessage::channelPressureChange(3, 127), 40);
+    bridge.write(events, queue.events);
+
+    REQUIRE(queue.numMidi == 0);
+    REQUIRE(queue.notes.size() == 1);
+    const auto noteId = queue.notes[0].note_id;
+
+    bool brightnessAtStart = false;
+    bool pressureLater = false;
+    for (const auto& e : queue.expressions) {
+        REQUIRE(e.note_id == noteId);
+        REQUIRE(e.key == 62);
+        if (e.expression_id == CLAP_NOTE_EXPRESSION_BRIGHTNESS && e.header.time == 0)
+            brightnessAtStart = e.value == 1.0;
+        if (e.expression_id == CLAP_NOTE_EXPRESSION_PRESSURE && e.header.time == 40)
+            pressureLater = e.value == 1.0;
+    }
+    REQUIRE(brightnessAtStart);
+    REQUIRE(pressureLater);
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include "engine/EngineTables.h"
+#include "engine/RomanNumeral.h"
+#include <thread>
+#include <vector>
+
+using namespace chordpumper;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Instances share one set of tables while any holds them", "[engine_tables]") {
+    auto first = EngineTables::shared();
+    auto second = EngineTables::shared();
+    REQUIRE(first != nullptr);
+    REQUIRE(first == second);
+}
+
+TEST_CASE("Concurrent first use builds the tables once", "[engine_tables]") {
+    std::vector<std::shared_ptr<const EngineTables>> seen(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < seen.size(); ++i)
+        threads.emplace_back([&seen, i] { seen[i] = EngineTables::shared(); });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& tables : seen)
+        REQUIRE(tables == seen.front());
+}
+
+TEST_CASE("Diatonic scores take the best fitting mode", "[engine_tables]") {
+    auto tables = EngineTables::shared();
+    REQUIRE_THAT(tables->diatonicScore(7, ChordType::Major), WithinAbs(1.0, 0.001));      // V, Ionian
+    REQUIRE_THAT(tables->diatonicScore(3, ChordType::Major), WithinAbs(0.85, 0.001));     // bIII, Aeolian
+    REQUIRE_THAT(tables->diatonicScore(0, ChordType::Dom7), WithinAbs(0.80, 0.001));      // I7, Mixolydian
+    REQUIRE_THAT(tables->diatonicScore(0, ChordType::Augmented), WithinAbs(0.0, 0.001));
+}
+
+TEST_CASE("Roman numerals match romanNumeral() for every interval and type", "[engine_tables]") {
+    auto tables = EngineTables::shared();
+    const Chord reference{pitches::D, ChordType::Minor};
+    for (int interval = 0; interval < 12; ++interval) {
+        for (int t = 0; t < kNumChordTypes; ++t) {
+            auto type = static_cast<ChordType>(t);
+            Chord suggestion{pitchClassFromSemitone((reference.root.semitone() + interval) % 12), type};
+            REQUIRE(tables->romanNumeral(interval, type) == romanNumeral(reference, suggestion));
+        }
+    }
+}
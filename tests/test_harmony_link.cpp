@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+#include "midi/HarmonyLink.h"
+#include <atomic>
+#include <thread>
+
+using namespace chordpumper;
+
+namespace {
+
+HarmonyLink::Harmony cMajorTriad() {
+    HarmonyLink::Harmony harmony;
+    harmony.chord = makeChordId(0, ChordType::Major);
+    harmony.key = 0x00ff0000;
+    harmony.numNotes = 3;
+    harmony.notes = {60, 64, 67};
+    return harmony;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Followers read what the leader published, once", "[harmony_link]") {
+    HarmonyLink link;
+    HarmonyLink::Harmony read;
+    uint32_t version = 0;
+    REQUIRE(!link.read(0, read, version));
+
+    link.publish(0, cMajorTriad());
+    REQUIRE(link.read(0, read, version));
+    REQUIRE(read == cMajorTriad());
+    REQUIRE(!link.read(0, read, version));
+
+    uint32_t otherGroupVersion = 0;
+    REQUIRE(!link.read(1, read, otherGroupVersion));
+}
+
+TEST_CASE("A group has one leader at a time", "[harmony_link]") {
+    HarmonyLink link;
+    auto first = link.newInstanceId();
+    auto second = link.newInstanceId();
+    REQUIRE(first != second);
+
+    REQUIRE(link.claimLeadership(2, first));
+    REQUIRE(link.claimLeadership(2, first));
+    REQUIRE(!link.claimLeadership(2, second));
+    REQUIRE(link.claimLeadership(3, second));
+
+    link.releaseLeadership(2, second);
+    REQUIRE(!link.claimLeadership(2, second));
+    link.releaseLeadership(2, first);
+    REQUIRE(link.claimLeadership(2, second));
+    REQUIRE(!link.claimLeadership(HarmonyLink::kNumGroups, first));
+}
+
+TEST_CASE("A leader going away silences its followers", "[harmony_link]") {
+    HarmonyLink link;
+    auto leader = link.newInstanceId();
+    auto other = link.newInstanceId();
+    REQUIRE(link.claimLeadership(4, leader));
+    link.publish(4, cMajorTriad());
+
+    HarmonyLink::Harmony read;
+    uint32_t version = 0;
+    std::array<uint8_t, HarmonyLink::kMaxNotes> held{};
+    REQUIRE(link.read(4, read, version));
+    REQUIRE(revoiceInRegister(read, 3, held) == 3);
+
+    // Only the leader can silence the group
+    link.releaseLeadership(4, other);
+    REQUIRE(!link.read(4, read, version));
+
+    link.releaseLeadership(4, leader);
+    REQUIRE(link.read(4, read, version));
+    REQUIRE(read.chord == kNoChord);
+    REQUIRE(read.numNotes == 0);
+    REQUIRE(revoiceInRegister(read, 3, held) == 0);
+    REQUIRE(link.claimLeadership(4, other));
+}
+
+TEST_CASE("Reads never observe a half-written harmony", "[harmony_link]") {
+    HarmonyLink link;
+    std::atomic<bool> done{false};
+
+    // Every field of a published harmony derives from one counter
+    std::thread leader([&] {
+        for (uint32_t i = 1; i <= 20000; ++i) {
+            HarmonyLink::Harmony harmony;
+            harmony.chord = static_cast<ChordId>(i % kNumChordIds);
+            harmony.key = i;
+            harmony.numNotes = HarmonyLink::kMaxNotes;
+            for (size_t n = 0; n < harmony.notes.size(); ++n)
+                harmony.notes[n] = static_cast<uint8_t>((i + n) & 0x7f);
+            link.publish(0, harmony);
+        }
+        done = true;
+    });
+
+    int torn = 0;
+    int reads = 0;
+    uint32_t version = 0;
+    while (!done) {
+        HarmonyLink::Harmony harmony;
+        if (!link.read(0, harmony, version))
+            continue;
+        ++reads;
+        const uint32_t i = harmony.key;
+        bool consistent = harmony.chord == static_cast<ChordId>(i % kNumChordIds);
+        for (size_t n = 0; n < harmony.notes.size(); ++n)
+            consistent = consistent && harmony.notes[n] == static_cast<uint8_t>((i + n) & 0x7f);
+        if (!consistent)
+            ++torn;
+    }
+    leader.join();
+
+    REQUIRE(torn == 0);
+    REQUIRE(reads > 0);
+}
+
+TEST_CASE("Re-voicing stacks the leader's pitch classes above its bass", "[harmony_link]") {
+    std::array<uint8_t, HarmonyLink::kMaxNotes> notes{};
+
+    // First-inversion C major, spread over two octaves
+    auto harmony = cMajorTriad();
+    harmony.notes = {52, 60, 67, 72};
+    harmony.numNotes = 4;
+    REQUIRE(revoiceInRegister(harmony, 2, notes) == 3);
+    REQUIRE(notes[0] == 40);
+    REQUIRE(notes[1] == 43);
+    REQUIRE(notes[2] == 48);
+
+    harmony.chord = kNoChord;
+    REQUIRE(revoiceInRegister(harmony, 2, notes) == 0);
+}
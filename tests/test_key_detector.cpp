@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+#include "engine/KeyDetector.h"
+#include <initializer_list>
+
+using namespace chordpumper;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+KeyEstimate detect(std::initializer_list<int> notes) {
+    KeyDetector detector;
+    detector.prepare(kRate);
+    for (int n : notes)
+        detector.noteOn(n, 0.8f);
+    for (int block = 0; block < 40; ++block)
+        detector.advance(512);
+    return detector.estimate();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Major scale with I-IV-V is detected as Ionian", "[key_detector]") {
+    auto key = detect({60, 62, 64, 65, 67, 69, 71, 72, 60, 64, 67, 65, 69, 72, 67, 71, 74, 60, 64, 67});
+    REQUIRE(key.isValid());
+    REQUIRE(key.tonic == 0);
+    REQUIRE(key.mode == 0);
+}
+
+TEST_CASE("Minor progression is detected as Aeolian on its tonic", "[key_detector]") {
+    auto key = detect({57, 60, 64, 62, 65, 69, 64, 67, 71, 57, 60, 64, 57, 59, 60, 62, 64, 65, 67});
+    REQUIRE(key.tonic == 9);
+    REQUIRE(key.mode == 5);
+}
+
+TEST_CASE("Tonic emphasis separates modes with the same pitch set", "[key_detector]") {
+    auto key = detect({62, 65, 69, 72, 62, 64, 65, 67, 69, 71, 72, 74, 67, 71, 74, 62, 65, 69});
+    REQUIRE(key.tonic == 2);
+    REQUIRE(key.mode == 1);  // Dorian
+}
+
+TEST_CASE("Too few notes give no estimate", "[key_detector]") {
+    auto key = detect({60});
+    REQUIRE(!key.isValid());
+}
+
+TEST_CASE("Estimates are throttled to the update interval", "[key_detector]") {
+    KeyDetector detector;
+    detector.prepare(kRate);
+    for (int n : {60, 64, 67, 65, 69, 72, 67, 71, 74})
+        detector.noteOn(n, 1.0f);
+
+    REQUIRE(!detector.advance(256));
+    REQUIRE(!detector.estimate().isValid());
+
+    bool changed = false;
+    for (int block = 0; block < 48; ++block)
+        changed = detector.advance(256) || changed;
+    REQUIRE(changed);
+    REQUIRE(detector.estimate().isValid());
+}
+
+TEST_CASE("Histogram decays with the configured half-life", "[key_detector]") {
+    KeyDetector detector;
+    detector.prepare(kRate);
+    detector.noteOn(60, 1.0f);
+    detector.advance(static_cast<int>(KeyDetector::kHalfLifeSeconds * kRate));
+    REQUIRE(detector.histogram()[0] > 0.49f);
+    REQUIRE(detector.histogram()[0] < 0.51f);
+}
+
+TEST_CASE("Key estimates survive packing", "[key_detector]") {
+    KeyEstimate key{7, 4, 0.8f};
+    auto unpacked = unpackKeyEstimate(packKeyEstimate(key, 3));
+    REQUIRE(unpacked.tonic == 7);
+    REQUIRE(unpacked.mode == 4);
+    REQUIRE(unpacked.confidence > 0.79f);
+    REQUIRE(unpacked.confidence < 0.81f);
+}
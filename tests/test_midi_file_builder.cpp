@@ -3,6 +3,7 @@
 #include "midi/MidiFileBuilder.h"
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
+#include <algorithm>
 
 using namespace chordpumper;
 
@@ -165,3 +166,107 @@ TEST_CASE("exportToDirectory creates parent directory", "[MidiFileBuilder]") {
     CHECK(file.getFileName() == juce::String("Dm7.mid"));
     dir.getParentDirectory().deleteRecursively();
 }
+
+TEST_CASE("Progression export follows tempo, meter and chord lengths", "[MidiFileBuilder]") {
+    std::vector<Chord> chords{{pitches::C, ChordType::Major}, {pitches::F, ChordType::Major}};
+    chords[1].lengthBeats = 2.0;
+
+    MidiFileBuilder::ExportOptions options;
+    options.bpm = 90.0;
+    options.timeSigNumerator = 3;
+    options.timeSigDenominator = 4;
+    options.voiceLead = false;
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getChildFile("chordpumper_test_progression.mid");
+    REQUIRE(MidiFileBuilder::exportProgression(chords, 4, file, options));
+
+    auto track = readFirstTrack(file);
+    bool foundTempo = false, foundMeter = false;
+    std::vector<double> fOns, fOffs;
+    for (int i = 0; i < track.getNumEvents(); ++i) {
+        auto& msg = track.getEventPointer(i)->message;
+        if (msg.isTempoMetaEvent()) {
+            foundTempo = true;
+            CHECK(msg.getTempoSecondsPerQuarterNote() == Catch::Approx(60.0 / 90.0).margin(0.001));
+        }
+        if (msg.isTimeSignatureMetaEvent()) {
+            int numerator = 0, denominator = 0;
+            msg.getTimeSignatureInfo(numerator, denominator);
+            foundMeter = numerator == 3 && denominator == 4;
+        }
+        if (msg.isNoteOn() && msg.getNoteNumber() == 65)
+            fOns.push_back(msg.getTimeStamp());
+        if (msg.isNoteOff() && msg.getNoteNumber() == 65)
+            fOffs.push_back(msg.getTimeStamp());
+    }
+    CHECK(foundTempo);
+    CHECK(foundMeter);
+    // C lasts one 3/4 bar (1440 ticks), F the recorded two beats
+    REQUIRE(fOns == std::vector<double>{1440.0});
+    REQUIRE(fOffs == std::vector<double>{2400.0});
+    file.deleteFile();
+}
+
+TEST_CASE("Progression export voice-leads and writes chord markers", "[MidiFileBuilder]") {
+    std::vector<Chord> chords{{pitches::C, ChordType::Major}, {pitches::F, ChordType::Major}};
+    chords[0].romanNumeral = "I";
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getChildFile("chordpumper_test_progression_vl.mid");
+    REQUIRE(MidiFileBuilder::exportProgression(chords, 4, file));
+
+    auto track = readFirstTrack(file);
+    juce::StringArray markers;
+    std::vector<int> secondChord;
+    for (int i = 0; i < track.getNumEvents(); ++i) {
+        auto& msg = track.getEventPointer(i)->message;
+        if (msg.isTextMetaEvent() && msg.getMetaEventType() == 6)
+            markers.add(msg.getTextFromTextMetaEvent());
+        if (msg.isNoteOn() && msg.getTimeStamp() == 1920.0)
+            secondChord.push_back(msg.getNoteNumber());
+    }
+    REQUIRE(markers == juce::StringArray{"C (I)", "F"});
+
+    // F keeps the common tone C4 instead of jumping to root position
+    std::sort(secondChord.begin(), secondChord.end());
+    REQUIRE(secondChord == std::vector<int>{60, 65, 69});
+    file.deleteFile();
+}
+
+TEST_CASE("A progression rendered in memory matches the exported file", "[MidiFileBuilder]") {
+    std::vector<Chord> chords{{pitches::A, ChordType::Minor7}, {pitches::D, ChordType::Major}};
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getChildFile("chordpumper_test_progression_memory.mid");
+    REQUIRE(MidiFileBuilder::exportProgression(chords, 4, file));
+
+    juce::MemoryBlock fromFile;
+    REQUIRE(file.loadFileAsData(fromFile));
+    REQUIRE(MidiFileBuilder::renderProgression(chords, 4) == fromFile);
+    REQUIRE(MidiFileBuilder::renderProgression({}, 4).isEmpty());
+    file.deleteFile();
+}
+
+TEST_CASE("Progression export leaves out notes shifted past the MIDI range", "[MidiFileBuilder]") {
+    std::vector<Chord> chords{{pitches::C, ChordType::Major}, {pitches::E, ChordType::Major}};
+    chords[0].octaveOffset = 5;  // 120, 124, 127
+    chords[1].octaveOffset = 5;  // 124, then 128 and 131 are out of range
+    MidiFileBuilder::ExportOptions options;
+    options.voiceLead = false;
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                    .getChildFile("chordpumper_test_progression_range.mid");
+    REQUIRE(MidiFileBuilder::exportProgression(chords, 4, file, options));
+
+    auto track = readFirstTrack(file);
+    std::vector<int> ons;
+    for (int i = 0; i < track.getNumEvents(); ++i) {
+        auto& msg = track.getEventPointer(i)->message;
+        if (msg.isNoteOn())
+            ons.push_back(msg.getNoteNumber());
+    }
+    std::sort(ons.begin(), ons.end());
+    REQUIRE(ons == std::vector<int>{120, 124, 124, 127});
+    file.deleteFile();
+}
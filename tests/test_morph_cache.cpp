@@ -0,0 +1,85 @@
+#include <catch2/catch_test_macros.hpp>
+#include "engine/MorphCache.h"
+#include "engine/PitchClass.h"
+#include "engine/Chord.h"
+#include "engine/ChordType.h"
+
+using namespace chordpumper;
+
+namespace {
+
+MorphResult dummyResult(int marker) {
+    MorphResult r{};
+    r.voiced.midiNotes = {marker};
+    return r;
+}
+
+} // anonymous namespace
+
+TEST_CASE("MorphCache misses until an entry is inserted", "[morph_cache]") {
+    MorphCache cache;
+    Chord c{pitches::C, ChordType::Major};
+    MorphWeights w;
+
+    REQUIRE(cache.find(c, {}, 4, w) == nullptr);
+    cache.insert(c, {}, 4, w, dummyResult(1));
+
+    auto hit = cache.find(c, {}, 4, w);
+    REQUIRE(hit != nullptr);
+    REQUIRE(hit->voiced.midiNotes == std::vector<int>{1});
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 1);
+}
+
+TEST_CASE("MorphCache keys on chord spelling, voicing, weights and grid size", "[morph_cache]") {
+    MorphCache cache;
+    Chord c{pitches::C, ChordType::Major};
+    MorphWeights w;
+    cache.insert(c, {60, 64, 67}, 4, w, dummyResult(1));
+
+    REQUIRE(cache.contains(c, {60, 64, 67}, 4, w));
+    REQUIRE(!cache.contains(c, {60, 64}, 4, w));
+    REQUIRE(!cache.contains(Chord{pitches::C, ChordType::Minor}, {60, 64, 67}, 4, w));
+    REQUIRE(!cache.contains(Chord{pitches::Cs, ChordType::Major}, {60, 64, 67}, 4, w));
+    REQUIRE(!cache.contains(c, {60, 64, 67}, 5, w));
+
+    MorphWeights other;
+    other.diatonic = 0.9f;
+    REQUIRE(!cache.contains(c, {60, 64, 67}, 4, other));
+    REQUIRE(!cache.contains(c, {60, 64, 67}, 4, w, 16));
+}
+
+TEST_CASE("MorphCache evicts the least recently used entry", "[morph_cache]") {
+    MorphCache cache(2);
+    MorphWeights w;
+    Chord a{pitches::C, ChordType::Major};
+    Chord b{pitches::D, ChordType::Minor};
+    Chord c{pitches::E, ChordType::Minor};
+
+    cache.insert(a, {}, 4, w, dummyResult(1));
+    cache.insert(b, {}, 4, w, dummyResult(2));
+    REQUIRE(cache.find(a, {}, 4, w) != nullptr);  // a is now most recent
+    cache.insert(c, {}, 4, w, dummyResult(3));
+
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.contains(a, {}, 4, w));
+    REQUIRE(!cache.contains(b, {}, 4, w));
+    REQUIRE(cache.contains(c, {}, 4, w));
+}
+
+TEST_CASE("MorphCache::compute matches an uncached morph", "[morph_cache]") {
+    MorphEngine engine;
+    Chord target{pitches::G, ChordType::Dom7};
+    std::vector<int> previous{60, 64, 67};
+
+    auto result = MorphCache::compute(engine, target, previous, 4);
+    auto voiced = optimalVoicing(target, previous, 4);
+    auto direct = engine.morph(target, voiced.midiNotes);
+
+    REQUIRE(result.voiced.midiNotes == voiced.midiNotes);
+    for (size_t i = 0; i < direct.size(); ++i) {
+        REQUIRE(result.suggestions[i].chord.root == direct[i].chord.root);
+        REQUIRE(result.suggestions[i].chord.type == direct[i].chord.type);
+        REQUIRE(result.suggestions[i].score == direct[i].score);
+    }
+}
@@ -15,16 +15,16 @@ std::vector<int> rootPosition(const Chord& chord, int octave = 4) {
     return chord.midiNotes(octave);
 }
 
-bool containsChord(const std::array<ScoredChord, 32>& results,
+bool containsChord(const std::vector<ScoredChord>& results,
                    PitchClass root, ChordType type) {
     return std::any_of(results.begin(), results.end(), [&](const ScoredChord& sc) {
         return sc.chord.root == root && sc.chord.type == type;
     });
 }
 
-int findRank(const std::array<ScoredChord, 32>& results,
+int findRank(const std::vector<ScoredChord>& results,
              PitchClass root, ChordType type) {
-    for (int i = 0; i < 32; ++i) {
+    for (int i = 0; i < static_cast<int>(results.size()); ++i) {
         if (results[static_cast<size_t>(i)].chord.root == root &&
             results[static_cast<size_t>(i)].chord.type == type)
             return i;
@@ -39,7 +39,7 @@ int findRank(const std::array<ScoredChord, 32>& results,
 TEST_CASE("MorphEngine returns exactly 32 results", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
     REQUIRE(results.size() == 32);
 
     for (const auto& sc : results) {
@@ -50,7 +50,7 @@ TEST_CASE("MorphEngine returns exactly 32 results", "[morph_engine]") {
 TEST_CASE("Results are sorted by score descending", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
 
     for (size_t i = 1; i < 32; ++i) {
         REQUIRE(results[i - 1].score >= results[i].score);
@@ -60,7 +60,7 @@ TEST_CASE("Results are sorted by score descending", "[morph_engine]") {
 TEST_CASE("Each result has a non-empty Roman numeral", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
 
     for (const auto& sc : results) {
         REQUIRE(!sc.romanNumeral.empty());
@@ -70,7 +70,7 @@ TEST_CASE("Each result has a non-empty Roman numeral", "[morph_engine]") {
 TEST_CASE("Scores are in valid range (0, 1]", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
 
     for (const auto& sc : results) {
         REQUIRE(sc.score > 0.0f);
@@ -121,7 +121,7 @@ TEST_CASE("scoreDiatonic: A minor is vi in Ionian = 1.0", "[morph_engine]") {
 TEST_CASE("Diatonic chords rank well for C major", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
 
     // vi ranks top 10 (high common tones + good VL after octave search)
     int amRank = findRank(results, pitches::A, ChordType::Minor);
@@ -141,7 +141,7 @@ TEST_CASE("Diatonic chords rank well for C major", "[morph_engine]") {
 TEST_CASE("Self-chord appears in results", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
 
     REQUIRE(containsChord(results, pitches::C, ChordType::Major));
 }
@@ -154,8 +154,8 @@ TEST_CASE("Transposition invariance: C major and D major produce equivalent rank
     Chord cMajor{pitches::C, ChordType::Major};
     Chord dMajor{pitches::D, ChordType::Major};
 
-    auto cResults = engine.morph(cMajor, rootPosition(cMajor));
-    auto dResults = engine.morph(dMajor, rootPosition(dMajor));
+    auto cResults = engine.morph(cMajor, rootPosition(cMajor), 32);
+    auto dResults = engine.morph(dMajor, rootPosition(dMajor), 32);
 
     for (size_t i = 0; i < 32; ++i) {
         int cInterval = (cResults[i].chord.root.semitone() -
@@ -172,7 +172,7 @@ TEST_CASE("Transposition invariance: C major and D major produce equivalent rank
 TEST_CASE("Variety filter: at least 2 from each quality category", "[morph_engine]") {
     MorphEngine engine;
     Chord cMajor{pitches::C, ChordType::Major};
-    auto results = engine.morph(cMajor, rootPosition(cMajor));
+    auto results = engine.morph(cMajor, rootPosition(cMajor), 32);
 
     int majorFamily = 0, minorFamily = 0, dimAug = 0;
     for (const auto& sc : results) {
@@ -200,7 +200,7 @@ TEST_CASE("Variety filter: at least 2 from each quality category", "[morph_engin
 TEST_CASE("Variety holds for minor reference chord too", "[morph_engine]") {
     MorphEngine engine;
     Chord aMinor{pitches::A, ChordType::Minor};
-    auto results = engine.morph(aMinor, rootPosition(aMinor));
+    auto results = engine.morph(aMinor, rootPosition(aMinor), 32);
 
     int majorFamily = 0, minorFamily = 0, dimAug = 0;
     for (const auto& sc : results) {
@@ -224,3 +224,33 @@ TEST_CASE("Variety holds for minor reference chord too", "[morph_engine]") {
     REQUIRE(minorFamily >= 2);
     REQUIRE(dimAug >= 2);
 }
+
+// --- Grid sizes ---
+
+TEST_CASE("morph returns exactly as many suggestions as pads", "[morph_engine]") {
+    MorphEngine engine;
+    Chord cMajor{pitches::C, ChordType::Major};
+    for (size_t count : {size_t(16), size_t(32), size_t(64), size_t(128)}) {
+        auto results = engine.morph(cMajor, rootPosition(cMajor), count);
+        REQUIRE(results.size() == count);
+        for (size_t i = 1; i < results.size(); ++i)
+            REQUIRE(results[i - 1].score >= results[i].score);
+        for (const auto& sc : results)
+            REQUIRE(!sc.romanNumeral.empty());
+    }
+}
+
+TEST_CASE("A small grid shows the leaders of a large one", "[morph_engine]") {
+    MorphEngine engine;
+    Chord cMajor{pitches::C, ChordType::Major};
+    auto small = engine.morph(cMajor, rootPosition(cMajor), 16);
+    auto large = engine.morph(cMajor, rootPosition(cMajor), 128);
+
+    // The variety filter may swap a few of the weakest, never the best
+    REQUIRE(small[0].chord.root == large[0].chord.root);
+    REQUIRE(small[0].chord.type == large[0].chord.type);
+    for (const auto& sc : small)
+        REQUIRE(std::any_of(large.begin(), large.end(), [&](const ScoredChord& other) {
+            return other.chord.root == sc.chord.root && other.chord.type == sc.chord.type;
+        }));
+}
@@ -0,0 +1,178 @@
+#include <catch2/catch_test_macros.hpp>
+#include "midi/MpeOutput.h"
+#include <set>
+#include <vector>
+
+using namespace chordpumper;
+
+namespace {
+
+using Policy = MpeChannelAllocator::Policy;
+
+juce::MidiBuffer chord(std::vector<int> notes, bool isNoteOn) {
+    juce::MidiBuffer midi;
+    for (int note : notes)
+        midi.addEvent(isNoteOn ? juce::MidiMessage::noteOn(1, note, 0.8f) : juce::MidiMessage::noteOff(1, note), 0);
+    return midi;
+}
+
+std::vector<juce::MidiMessage> messages(const juce::MidiBuffer& midi) {
+    std::vector<juce::MidiMessage> result;
+    for (const auto metadata : midi)
+        result.push_back(metadata.getMessage());
+    return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Round robin cycles through the member channels", "[mpe_output]") {
+    MpeChannelAllocator allocator;
+    allocator.setPolicy(Policy::RoundRobin);
+
+    REQUIRE(allocator.allocate(60).channel == 2);
+    REQUIRE(allocator.allocate(64).channel == 3);
+    REQUIRE(allocator.release(60) == 2);
+    // Channel 2 is free again but round robin moves on
+    REQUIRE(allocator.allocate(67).channel == 4);
+
+    for (int note = 70; note < 83; ++note)
+        allocator.allocate(note);
+    REQUIRE(allocator.getNumVoices() == 15);
+    REQUIRE(allocator.channelForNote(81) == 16);
+    REQUIRE(allocator.channelForNote(82) == 2);
+}
+
+TEST_CASE("Least recently used reuses the longest-silent channel", "[mpe_output]") {
+    MpeChannelAllocator allocator;
+    allocator.setPolicy(Policy::LeastRecentlyUsed);
+
+    for (int note = 60; note < 63; ++note)
+        allocator.allocate(note);
+    allocator.release(61);  // channel 3
+    allocator.release(60);  // channel 2
+
+    // Channels 5-16 have never sounded, so they go first; then 3, then 2
+    for (int note = 70; note < 82; ++note)
+        allocator.allocate(note);
+    REQUIRE(allocator.allocate(90).channel == 3);
+    REQUIRE(allocator.allocate(91).channel == 2);
+}
+
+TEST_CASE("A full zone steals its oldest voice", "[mpe_output]") {
+    MpeChannelAllocator allocator;
+    for (int note = 40; note < 55; ++note)
+        REQUIRE(allocator.allocate(note).stolenNote == -1);
+
+    const auto allocation = allocator.allocate(80);
+    REQUIRE(allocation.stolenNote == 40);
+    REQUIRE(allocator.channelForNote(40) == 0);
+    REQUIRE(allocator.channelForNote(80) == allocation.channel);
+    REQUIRE(allocator.release(40) == 0);
+    REQUIRE(allocator.getNumVoices() == 15);
+}
+
+TEST_CASE("MPE output gives each chord voice its own channel and expression", "[mpe_output]") {
+    MpeOutput mpe;
+    mpe.prepare();
+    mpe.setEnabled(true);
+
+    juce::MidiBuffer expression;
+    expression.addEvent(juce::MidiMessage::controllerEvent(1, MpeOutput::kTimbreController, 100), 0);
+    juce::MidiBuffer output;
+    mpe.process(chord({60, 64, 67}, true), expression, 256, output);
+
+    std::set<int> channels;
+    bool configured = false;
+    for (const auto& m : messages(output)) {
+        if (m.isNoteOn()) {
+            REQUIRE(m.getChannel() >= 2);
+            channels.insert(m.getChannel());
+        }
+        if (m.isControllerOfType(6) && m.getChannel() == MpeOutput::kMasterChannel)
+            configured = m.getControllerValue() == 15;
+        if (m.isControllerOfType(MpeOutput::kTimbreController) && m.getChannel() >= 2)
+            REQUIRE(m.getControllerValue() == 100);
+    }
+    REQUIRE(configured);
+    REQUIRE(channels.size() == 3);
+
+    // Channel pressure reaches every voice; poly aftertouch only its own
+    expression.clear();
+    expression.addEvent(juce::MidiMessage::channelPressureChange(1, 90), 0);
+    expression.addEvent(juce::MidiMessage::aftertouchChange(1, 64, 30), 10);
+    output.clear();
+    mpe.process({}, expression, 256, output);
+
+    int pressure90 = 0;
+    for (const auto& m : messages(output)) {
+        if (m.isChannelPressure() && m.getChannelPressureValue() == 90)
+            ++pressure90;
+        if (m.isChannelPressure() && m.getChannelPressureValue() == 30)
+            REQUIRE(m.getChannel() == mpe.getAllocator().channelForNote(64));
+    }
+    REQUIRE(pressure90 == 3);
+}
+
+TEST_CASE("Switching MPE off keeps note-offs on their voice channels", "[mpe_output]") {
+    MpeOutput mpe;
+    mpe.prepare();
+    mpe.setEnabled(true);
+    juce::MidiBuffer output;
+    mpe.process(chord({60, 64}, true), {}, 256, output);
+    const int channel = mpe.getAllocator().channelForNote(64);
+
+    mpe.setEnabled(false);
+    output.clear();
+    mpe.process(chord({60, 64}, false), {}, 256, output);
+    for (const auto& m : messages(output))
+        if (m.getNoteNumber() == 64)
+            REQUIRE(m.getChannel() == channel);
+
+    output.clear();
+    mpe.process(chord({62}, true), {}, 256, output);
+    REQUIRE(messages(output).size() == 1);
+    REQUIRE(messages(output)[0].getChannel() == 1);
+    REQUIRE(mpe.getAllocator().getNumVoices() == 0);
+}
+
+TEST_CASE("A note held across enabling MPE is released on every channel", "[mpe_output]") {
+    MpeOutput mpe;
+    mpe.prepare();
+    juce::MidiBuffer output;
+    mpe.process(chord({60}, true), {}, 256, output);
+
+    mpe.setEnabled(true);
+    mpe.process(chord({60}, true), {}, 256, output);
+    const int voiceChannel = mpe.getAllocator().channelForNote(60);
+    REQUIRE(voiceChannel >= MpeChannelAllocator::kFirstMemberChannel);
+
+    output.clear();
+    mpe.process(chord({60}, false), {}, 256, output);
+    std::set<int> released;
+    for (const auto& m : messages(output))
+        if (m.isNoteOff() && m.getNoteNumber() == 60)
+            released.insert(m.getChannel());
+    REQUIRE(released == std::set<int>{1, voiceChannel});
+}
+
+TEST_CASE("Switching MPE off removes the zone", "[mpe_output]") {
+    MpeOutput mpe;
+    mpe.prepare();
+    mpe.setEnabled(true);
+    juce::MidiBuffer output;
+    mpe.process({}, {}, 256, output);
+
+    mpe.setEnabled(false);
+    output.clear();
+    mpe.process({}, {}, 256, output);
+
+    // RPN 6 (MPE Configuration Message) on the master channel with no member channels
+    const auto sent = messages(output);
+    REQUIRE(sent.size() == 4);
+    REQUIRE(sent[1].isControllerOfType(100));
+    REQUIRE(sent[1].getControllerValue() == 6);
+    REQUIRE(sent[2].isControllerOfType(6));
+    REQUIRE(sent[2].getControllerValue() == 0);
+    for (const auto& m : sent)
+        REQUIRE(m.getChannel() == MpeOutput::kMasterChannel);
+}
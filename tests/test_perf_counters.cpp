@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+#include "diagnostics/PerfCounters.h"
+#include <thread>
+
+using namespace chordpumper;
+
+TEST_CASE("PerfStat starts empty", "[perf_counters]") {
+    PerfStat stat;
+    REQUIRE(stat.read().count == 0);
+}
+
+TEST_CASE("PerfStat tracks last, smoothed average and max", "[perf_counters]") {
+    PerfStat stat;
+    stat.add(2.0f);
+    stat.add(4.0f);
+    stat.add(1.0f);
+
+    auto s = stat.read();
+    REQUIRE(s.count == 3);
+    REQUIRE(s.last == 1.0f);
+    REQUIRE(s.max == 4.0f);
+    REQUIRE(s.average > 1.0f);
+    REQUIRE(s.average < 4.0f);
+}
+
+TEST_CASE("PerfStat reset takes effect on the next sample", "[perf_counters]") {
+    PerfStat stat;
+    stat.add(10.0f);
+    stat.reset();
+    stat.add(1.0f);
+
+    auto s = stat.read();
+    REQUIRE(s.count == 1);
+    REQUIRE(s.max == 1.0f);
+    REQUIRE(s.average == 1.0f);
+}
+
+TEST_CASE("ScopedTimer records elapsed milliseconds", "[perf_counters]") {
+    PerfStat stat;
+    {
+        const PerfStat::ScopedTimer timer(stat);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    REQUIRE(stat.read().last >= 2.0f);
+}
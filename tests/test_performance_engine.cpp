@@ -0,0 +1,205 @@
+#include <catch2/catch_test_macros.hpp>
+#include "midi/PerformanceEngine.h"
+#include <vector>
+
+using namespace chordpumper;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+struct Event {
+    long long sample;
+    bool isNoteOn;
+    int note;
+};
+
+// Feeds the engine block by block with a transport at 120 BPM, collecting
+// its output on an absolute sample timeline.
+struct Host {
+    PerformanceEngine engine;
+    double ppq = 0.0;
+    bool playing = true;
+    long long sample = 0;
+    std::vector<Event> events;
+    juce::MidiBuffer input;
+
+    explicit Host(PerformanceEngine::Settings settings) {
+        engine.prepare(kRate);
+        engine.setSettings(settings);
+    }
+
+    void chordOn(std::vector<int> notes, int offset = 0) {
+        for (int note : notes)
+            input.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), offset);
+    }
+
+    void chordOff(std::vector<int> notes, int offset = 0) {
+        for (int note : notes)
+            input.addEvent(juce::MidiMessage::noteOff(1, note), offset);
+    }
+
+    void run(int numSamples) {
+        juce::MidiBuffer output;
+        engine.process(input, {playing, ppq, 120.0, 4.0}, numSamples, output);
+        input.clear();
+        for (const auto metadata : output) {
+            auto message = metadata.getMessage();
+            events.push_back({sample + metadata.samplePosition, message.isNoteOn(), message.getNoteNumber()});
+        }
+        sample += numSamples;
+        if (playing)
+            ppq += numSamples * 120.0 / (60.0 * kRate);
+    }
+
+    void runUntil(long long end, int blockSize) {
+        while (sample < end)
+            run(static_cast<int>(std::min<long long>(blockSize, end - sample)));
+    }
+
+    std::vector<Event> noteOns() const {
+        std::vector<Event> ons;
+        for (const auto& e : events)
+            if (e.isNoteOn)
+                ons.push_back(e);
+        return ons;
+    }
+};
+
+PerformanceEngine::Settings strum(PerformanceEngine::StrumDirection direction) {
+    PerformanceEngine::Settings settings;
+    settings.mode = PerformanceEngine::Mode::Strum;
+    settings.strumAmount = 10.0;  // ms = 480 samples
+    settings.strumDirection = direction;
+    return settings;
+}
+
+PerformanceEngine::Settings arpeggio(PerformanceEngine::ArpPattern pattern, int ratchets = 1) {
+    PerformanceEngine::Settings settings;
+    settings.mode = PerformanceEngine::Mode::Arpeggio;
+    settings.arpPattern = pattern;
+    settings.arpStepBeats = 0.25;  // 1/16 at 120 BPM = 6000 samples
+    settings.arpGate = 0.5;
+    settings.ratchets = ratchets;
+    return settings;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Chord mode passes notes through at their offsets", "[performance_engine]") {
+    Host host(PerformanceEngine::Settings{});
+    host.chordOn({60, 64, 67}, 17);
+    host.run(512);
+
+    REQUIRE(host.events.size() == 3);
+    for (const auto& e : host.events)
+        REQUIRE(e.sample == 17);
+}
+
+TEST_CASE("Strum spreads voices across blocks in either direction", "[performance_engine]") {
+    Host up(strum(PerformanceEngine::StrumDirection::Up));
+    up.chordOn({67, 60, 64}, 100);
+    up.runUntil(4096, 256);
+
+    auto ons = up.noteOns();
+    REQUIRE(ons.size() == 3);
+    REQUIRE(ons[0].note == 60);
+    REQUIRE(ons[0].sample == 100);
+    REQUIRE(ons[1].note == 64);
+    REQUIRE(ons[1].sample == 580);
+    REQUIRE(ons[2].note == 67);
+    REQUIRE(ons[2].sample == 1060);
+
+    Host down(strum(PerformanceEngine::StrumDirection::Down));
+    down.chordOn({60, 64, 67});
+    down.runUntil(4096, 256);
+    ons = down.noteOns();
+    REQUIRE(ons.size() == 3);
+    REQUIRE(ons[0].note == 67);
+    REQUIRE(ons[2].note == 60);
+    REQUIRE(ons[2].sample == 960);
+}
+
+TEST_CASE("Strummed voices keep their length on release", "[performance_engine]") {
+    Host host(strum(PerformanceEngine::StrumDirection::Up));
+    host.chordOn({60, 64, 67});
+    host.run(256);
+    host.chordOff({60, 64, 67});
+    host.runUntil(4096, 256);
+
+    long long offOf67 = -1;
+    for (const auto& e : host.events)
+        if (!e.isNoteOn && e.note == 67)
+            offOf67 = e.sample;
+    REQUIRE(offOf67 == 256 + 960);
+    REQUIRE(host.engine.getNumSounding() == 0);
+}
+
+TEST_CASE("Arpeggio steps land on the host grid", "[performance_engine]") {
+    for (int blockSize : {64, 333, 1024}) {
+        Host host(arpeggio(PerformanceEngine::ArpPattern::UpDown));
+        host.ppq = 0.1;  // the first hit is immediate, the rest follow the grid
+        host.chordOn({64, 60, 67});
+        host.runUntil(4 * 6000, blockSize);
+
+        auto ons = host.noteOns();
+        REQUIRE(ons.size() == 5);
+        REQUIRE(ons[0].sample == 0);
+        // ppq 0.25 is 0.15 beats (3600 samples) after the start
+        for (size_t i = 1; i < ons.size(); ++i)
+            REQUIRE(ons[i].sample == 3600 + static_cast<long long>(i - 1) * 6000);
+
+        std::vector<int> notes;
+        for (const auto& e : ons)
+            notes.push_back(e.note);
+        REQUIRE(notes == std::vector<int>{60, 64, 67, 64, 60});
+    }
+}
+
+TEST_CASE("Ratchets repeat each step and release before the next hit", "[performance_engine]") {
+    Host host(arpeggio(PerformanceEngine::ArpPattern::Up, 3));
+    host.chordOn({60, 64});
+    host.runUntil(2 * 6000, 256);
+
+    auto ons = host.noteOns();
+    REQUIRE(ons.size() == 6);
+    REQUIRE(ons[0].note == 60);
+    REQUIRE(ons[2].note == 60);
+    REQUIRE(ons[3].note == 64);
+    REQUIRE(ons[3].sample == 6000);
+    REQUIRE(ons[1].sample == 2000);
+
+    host.chordOff({60, 64});
+    host.runUntil(3 * 6000, 256);
+    REQUIRE(host.noteOns().size() == 6);
+    REQUIRE(host.engine.getNumSounding() == 0);
+}
+
+TEST_CASE("Changing mode releases everything sounding", "[performance_engine]") {
+    auto settings = arpeggio(PerformanceEngine::ArpPattern::Repeat);
+    settings.arpGate = 1.0;
+    Host host(settings);
+    host.chordOn({60, 64, 67});
+    host.run(512);
+    REQUIRE(host.engine.getNumSounding() == 3);
+
+    host.engine.setSettings(PerformanceEngine::Settings{});
+    host.run(512);
+    REQUIRE(host.engine.getNumSounding() == 0);
+}
+
+TEST_CASE("A gate that opens and closes within one block leaves nothing sounding", "[performance_engine]") {
+    Host host(arpeggio(PerformanceEngine::ArpPattern::Up, 4));  // 1500-sample hits, 750-sample gates
+    host.chordOn({60});
+    host.run(1000);
+
+    REQUIRE(host.events.size() == 2);
+    REQUIRE(host.events[0].isNoteOn);
+    REQUIRE(!host.events[1].isNoteOn);
+    REQUIRE(host.events[1].sample == 750);
+    REQUIRE(host.engine.getNumSounding() == 0);
+
+    juce::MidiBuffer released;
+    host.engine.allNotesOff(released, 0);
+    REQUIRE(released.getNumEvents() == 0);
+}
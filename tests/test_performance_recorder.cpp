@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include "midi/PerformanceRecorder.h"
+#include "engine/PitchClass.h"
+#include <vector>
+
+using namespace chordpumper;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+constexpr double kPpqPerSample = 120.0 / (60.0 * kRate);
+
+std::vector<RecordedEvent> drainAll(PerformanceRecorder& recorder) {
+    std::vector<RecordedEvent> events;
+    recorder.drain([&events](const RecordedEvent& e) { events.push_back(e); });
+    return events;
+}
+
+void playTriad(PerformanceRecorder& recorder, int root, int offset) {
+    recorder.noteOn(root, offset);
+    recorder.noteOn(root + 4, offset);
+    recorder.noteOn(root + 7, offset);
+}
+
+void releaseTriad(PerformanceRecorder& recorder, int root, int offset) {
+    recorder.noteOff(root, offset);
+    recorder.noteOff(root + 4, offset);
+    recorder.noteOff(root + 7, offset);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Chord changes are stamped with the host PPQ at their sample", "[recorder]") {
+    PerformanceRecorder recorder;
+    recorder.prepare(kRate);
+    recorder.setArmed(true);
+
+    recorder.beginBlock({true, 8.0, 120.0, 4.0}, 512);
+    playTriad(recorder, 60, 100);
+    releaseTriad(recorder, 60, 400);
+
+    auto events = drainAll(recorder);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].chord == makeChordId(0, ChordType::Major));
+    REQUIRE_THAT(events[0].ppq, WithinAbs(8.0 + 100 * kPpqPerSample, 1e-9));
+    REQUIRE(events[1].chord == kNoChord);
+    REQUIRE_THAT(events[1].ppq, WithinAbs(8.0 + 400 * kPpqPerSample, 1e-9));
+}
+
+TEST_CASE("Nothing is recorded until armed, and disarming closes the take", "[recorder]") {
+    PerformanceRecorder recorder;
+    recorder.prepare(kRate);
+
+    recorder.beginBlock({true, 0.0, 120.0, 4.0}, 512);
+    playTriad(recorder, 60, 0);
+    REQUIRE(drainAll(recorder).empty());
+
+    recorder.setArmed(true);
+    recorder.beginBlock({true, 1.0, 120.0, 4.0}, 512);
+    releaseTriad(recorder, 60, 0);
+    playTriad(recorder, 65, 10);
+
+    recorder.setArmed(false);
+    recorder.beginBlock({true, 2.0, 120.0, 4.0}, 512);
+
+    auto events = drainAll(recorder);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].chord == makeChordId(5, ChordType::Major));
+    REQUIRE(events[1].chord == kNoChord);
+    REQUIRE_THAT(events[1].ppq, WithinAbs(2.0, 1e-9));
+}
+
+TEST_CASE("A stopped transport records on a free-running clock", "[recorder]") {
+    PerformanceRecorder recorder;
+    recorder.prepare(kRate);
+    recorder.setArmed(true);
+
+    recorder.beginBlock({false, 0.0, 120.0, 4.0}, 24000);
+    recorder.beginBlock({false, 0.0, 120.0, 4.0}, 24000);
+    playTriad(recorder, 62, 0);
+
+    auto events = drainAll(recorder);
+    REQUIRE(events.size() == 1);
+    REQUIRE_THAT(events[0].ppq, WithinAbs(1.0, 1e-9));
+}
+
+TEST_CASE("Long takes drained by the UI lose nothing", "[recorder]") {
+    PerformanceRecorder recorder;
+    recorder.prepare(kRate);
+    recorder.setArmed(true);
+
+    size_t received = 0;
+    for (int block = 0; block < 20000; ++block) {
+        recorder.beginBlock({true, block * 512 * kPpqPerSample, 120.0, 4.0}, 512);
+        playTriad(recorder, 60 + block % 12, 0);
+        releaseTriad(recorder, 60 + block % 12, 256);
+        if (block % 200 == 0)
+            received += drainAll(recorder).size();
+    }
+    received += drainAll(recorder).size();
+
+    REQUIRE(recorder.getNumDropped() == 0);
+    REQUIRE(received == 40000);
+}
+
+TEST_CASE("Takes snap to the grid and run to the next change", "[recorder]") {
+    TakeBuilder take(1.0);
+    const auto c = makeChordId(0, ChordType::Major);
+    const auto f = makeChordId(5, ChordType::Major);
+    const auto g = makeChordId(7, ChordType::Major);
+
+    REQUIRE(!take.add({0.1, c, 0}));
+    auto first = take.add({1.9, f, 0});
+    REQUIRE(first);
+    REQUIRE(first->root == pitches::C);
+    REQUIRE_THAT(first->lengthBeats, WithinAbs(2.0, 1e-9));
+
+    // C snaps onto the grid line where G starts and replaces it
+    auto second = take.add({3.8, g, 0});
+    REQUIRE(second);
+    REQUIRE_THAT(second->lengthBeats, WithinAbs(2.0, 1e-9));
+    REQUIRE(!take.add({4.2, c, 0}));
+
+    auto third = take.add({6.1, kNoChord, 0});
+    REQUIRE(third);
+    REQUIRE(third->root == pitches::C);
+    REQUIRE_THAT(third->lengthBeats, WithinAbs(2.0, 1e-9));
+}
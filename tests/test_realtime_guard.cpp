@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include "diagnostics/RealtimeGuard.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace chordpumper;
+
+namespace {
+
+// Keeps the optimiser from eliding a new/delete pair
+void* volatile sink = nullptr;
+
+void allocateSomething() {
+    auto block = std::make_unique<std::vector<int>>(128);
+    sink = block.get();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Allocation inside a realtime section is recorded", "[realtime_guard]") {
+    RealtimeGuard::warmUp();
+    RealtimeGuard::reset();
+    {
+        const RealtimeGuard::ScopedSection section;
+        allocateSomething();
+    }
+    REQUIRE(RealtimeGuard::getNumViolations() >= 2);
+    auto first = RealtimeGuard::getRecord(0);
+    REQUIRE(first.kind == RealtimeGuard::Violation::Allocation);
+    REQUIRE(first.bytes > 0);
+    REQUIRE(first.numFrames > 0);
+    REQUIRE(!RealtimeGuard::describe().empty());
+}
+
+TEST_CASE("Allocation outside a realtime section is ignored", "[realtime_guard]") {
+    RealtimeGuard::reset();
+    allocateSomething();
+    REQUIRE(RealtimeGuard::getNumViolations() == 0);
+    REQUIRE(!RealtimeGuard::isInSection());
+}
+
+TEST_CASE("Mutex acquisition inside a realtime section is recorded", "[realtime_guard]") {
+    std::mutex mutex;
+    RealtimeGuard::reset();
+    {
+        const RealtimeGuard::ScopedSection section;
+        const std::lock_guard<std::mutex> lock(mutex);
+    }
+    REQUIRE(RealtimeGuard::getNumViolations() == 1);
+    REQUIRE(RealtimeGuard::getRecord(0).kind == RealtimeGuard::Violation::Lock);
+}
+
+TEST_CASE("Sections nest and clean code stays clean", "[realtime_guard]") {
+    bool innerActive = false;
+    bool outerActiveAfterInner = false;
+    int total = 0;
+
+    RealtimeGuard::reset();
+    {
+        const RealtimeGuard::ScopedSection outer;
+        {
+            const RealtimeGuard::ScopedSection inner;
+            innerActive = RealtimeGuard::isInSection();
+        }
+        outerActiveAfterInner = RealtimeGuard::isInSection();
+
+        for (int i = 0; i < 64; ++i)
+            total += i;
+    }
+
+    REQUIRE(innerActive);
+    REQUIRE(outerActiveAfterInner);
+    REQUIRE(total == 2016);
+    REQUIRE(!RealtimeGuard::isInSection());
+    REQUIRE(RealtimeGuard::getNumViolations() == 0);
+}
@@ -4,6 +4,7 @@
 #include "engine/PitchClass.h"
 #include "engine/Chord.h"
 #include "engine/ChordType.h"
+#include "engine/RomanNumeral.h"
 
 using namespace chordpumper;
 using namespace chordpumper::pitches;
@@ -17,6 +18,7 @@ TEST_CASE("Default state round-trips", "[state]")
 
     REQUIRE(restored.hasMorphed == false);
     REQUIRE(restored.progression.empty());
+    REQUIRE(restored.syncToHost == false);
     REQUIRE_THAT(restored.weights.diatonic, WithinAbs(0.40, 0.001));
     REQUIRE_THAT(restored.weights.commonTones, WithinAbs(0.25, 0.001));
     REQUIRE_THAT(restored.weights.voiceLeading, WithinAbs(0.25, 0.001));
@@ -48,6 +50,8 @@ TEST_CASE("Populated state round-trips", "[state]")
     original.progression.push_back({C, ChordType::Major});
     original.progression.push_back({F, ChordType::Major});
     original.progression.push_back({G, ChordType::Dom7});
+    original.progression.back().lengthBeats = 1.5;
+    original.syncToHost = true;
 
     original.weights = {0.5f, 0.3f, 0.2f};
 
@@ -77,6 +81,9 @@ TEST_CASE("Populated state round-trips", "[state]")
     REQUIRE(restored.progression[1].type == ChordType::Major);
     REQUIRE(restored.progression[2].root == G);
     REQUIRE(restored.progression[2].type == ChordType::Dom7);
+    REQUIRE_THAT(restored.progression[0].lengthBeats, WithinAbs(0.0, 0.001));
+    REQUIRE_THAT(restored.progression[2].lengthBeats, WithinAbs(1.5, 0.001));
+    REQUIRE(restored.syncToHost == true);
 
     REQUIRE_THAT(restored.weights.diatonic, WithinAbs(0.5, 0.001));
     REQUIRE_THAT(restored.weights.commonTones, WithinAbs(0.3, 0.001));
@@ -101,6 +108,131 @@ TEST_CASE("ValueTree determinism", "[state]")
     REQUIRE(tree1.isEquivalentTo(tree2));
 }
 
+TEST_CASE("Grid size round-trips and bounds the saved pads", "[state]")
+{
+    PersistentState original;
+    REQUIRE(original.toValueTree().getChildWithName("Grid").getNumChildren() == 64);
+
+    original.gridSize = {16, 8};
+    original.gridChords[100] = {Eb, ChordType::Min9};
+    original.romanNumerals[100] = "iii9";
+    auto tree = original.toValueTree();
+    REQUIRE(tree.getChildWithName("Grid").getNumChildren() == 128);
+
+    auto restored = PersistentState::fromValueTree(tree);
+    REQUIRE(restored.gridSize == GridSize{16, 8});
+    REQUIRE(restored.gridChords[100].root == Eb);
+    REQUIRE(restored.gridChords[100].type == ChordType::Min9);
+    REQUIRE(restored.romanNumerals[100] == "iii9");
+
+    SECTION("Unknown layouts fall back to 8 x 8")
+    {
+        tree.getChildWithName("Grid").setProperty("columns", 5, nullptr);
+        REQUIRE(PersistentState::fromValueTree(tree).gridSize == GridSize{});
+    }
+}
+
+TEST_CASE("Banks switch without losing the grid they leave", "[state]")
+{
+    PersistentState state;
+    state.hasMorphed = true;
+    state.lastPlayedChord = {A, ChordType::Minor};
+    state.lastVoicing = {57, 60, 64};
+    state.gridChords[0] = {F, ChordType::Major};
+    state.gridChords[1] = {G, ChordType::Dom7};
+
+    state.switchBank(2);
+    REQUIRE(state.activeBank == 2);
+    REQUIRE(state.hasMorphed == false);
+    REQUIRE(state.gridChords[0].root == C);
+    REQUIRE(state.storedBanks[0].has_value());
+
+    state.switchBank(0);
+    REQUIRE(state.hasMorphed);
+    REQUIRE(state.lastPlayedChord.root == A);
+    REQUIRE(state.lastVoicing == std::vector<int>{57, 60, 64});
+    REQUIRE(state.gridChords[0].root == F);
+    REQUIRE(state.gridChords[1].type == ChordType::Dom7);
+    REQUIRE(state.romanNumerals[0] == romanNumeral(state.lastPlayedChord, state.gridChords[0]));
+
+    // Bank 2 was only looked at, so there is nothing to keep
+    REQUIRE(!state.storedBanks[2].has_value());
+}
+
+TEST_CASE("Only morphed banks are serialised", "[state]")
+{
+    PersistentState original;
+    original.hasMorphed = true;
+    original.lastPlayedChord = {D, ChordType::Minor};
+    original.gridChords[3] = {Bb, ChordType::Maj7};
+    original.switchBank(1);
+    original.switchBank(3);
+
+    auto tree = original.toValueTree();
+    auto banks = tree.getChildWithName("Banks");
+    REQUIRE(static_cast<int>(banks.getProperty("active")) == 3);
+    REQUIRE(banks.getNumChildren() == 1);
+
+    auto restored = PersistentState::fromValueTree(tree);
+    REQUIRE(restored.activeBank == 3);
+    REQUIRE(restored.storedBanks[0].has_value());
+    REQUIRE(!restored.storedBanks[1].has_value());
+
+    restored.switchBank(0);
+    REQUIRE(restored.lastPlayedChord.root == D);
+    REQUIRE(restored.gridChords[3].root == Bb);
+    REQUIRE(restored.gridChords[3].type == ChordType::Maj7);
+}
+
+TEST_CASE("Only dirty sections are re-encoded", "[state]")
+{
+    PersistentState state;
+    juce::ValueTree tree;
+    REQUIRE(state.updateValueTree(tree));
+    REQUIRE(tree.isEquivalentTo(state.toValueTree()));
+    REQUIRE(!state.updateValueTree(tree));
+
+    const auto grid = tree.getChildWithName("Grid");
+    const auto progression = tree.getChildWithName("Progression");
+    tree.appendChild(juce::ValueTree("Parameters"), nullptr);
+
+    state.progression.push_back({G, ChordType::Dom7});
+    state.markDirty(PersistentState::kProgressionSection);
+    REQUIRE(state.updateValueTree(tree));
+
+    // Clean sections keep their node; the dirty one is written again in place
+    REQUIRE(tree.getChildWithName("Grid") == grid);
+    REQUIRE(tree.getChildWithName("Progression") != progression);
+    REQUIRE(tree.getChildWithName("Progression").getNumChildren() == 1);
+    REQUIRE(tree.getChild(tree.getNumChildren() - 1).hasType("Parameters"));
+    REQUIRE(!state.updateValueTree(tree));
+}
+
+TEST_CASE("Updated trees match a full encode", "[state]")
+{
+    PersistentState state;
+    juce::ValueTree tree;
+    state.updateValueTree(tree);
+
+    state.hasMorphed = true;
+    state.lastPlayedChord = {E, ChordType::Minor};
+    state.lastVoicing = {52, 55, 59};
+    state.gridChords[2] = {B, ChordType::HalfDim7};
+    state.markDirty(PersistentState::kGridSection | PersistentState::kMorphContextSection);
+    state.updateValueTree(tree);
+    REQUIRE(tree.isEquivalentTo(state.toValueTree()));
+
+    // Leaving for an unmorphed bank drops the morph context again
+    state.switchBank(1);
+    state.updateValueTree(tree);
+    REQUIRE(!tree.getChildWithName("MorphContext").isValid());
+    REQUIRE(tree.isEquivalentTo(state.toValueTree()));
+
+    state.switchBank(0);
+    state.updateValueTree(tree);
+    REQUIRE(tree.isEquivalentTo(state.toValueTree()));
+}
+
 TEST_CASE("Corrupt data handling", "[state]")
 {
     SECTION("Invalid (empty) tree returns default state")
@@ -0,0 +1,157 @@
+#include <catch2/catch_test_macros.hpp>
+#include "midi/StripSequencer.h"
+#include "midi/TripleBuffer.h"
+#include "engine/PitchClass.h"
+#include <vector>
+
+using namespace chordpumper;
+using namespace chordpumper::pitches;
+
+namespace {
+
+constexpr double kRate = 48000.0;
+
+struct Event {
+    long long sample;
+    bool isNoteOn;
+    int note;
+};
+
+// Drives the sequencer like a host: the playhead advances by each block's
+// length at the tempo in effect for that block.
+struct Host {
+    StripSequencer sequencer;
+    double ppq = 0.0;
+    double bpm = 120.0;
+    long long sample = 0;
+    bool playing = true;
+    std::vector<Event> events;
+
+    Host(std::vector<Chord> progression) {
+        sequencer.prepare(kRate);
+        sequencer.publish(SequenceSnapshot::fromProgression(progression, true));
+    }
+
+    void run(int numSamples) {
+        juce::MidiBuffer midi;
+        sequencer.process({playing, ppq, bpm, 4.0}, numSamples, midi);
+        for (const auto metadata : midi) {
+            auto message = metadata.getMessage();
+            events.push_back({sample + metadata.samplePosition, message.isNoteOn(), message.getNoteNumber()});
+        }
+        sample += numSamples;
+        if (playing)
+            ppq += numSamples * bpm / (60.0 * kRate);
+    }
+
+    std::vector<long long> noteOnTimes(int note) const {
+        std::vector<long long> times;
+        for (const auto& e : events)
+            if (e.isNoteOn && e.note == note)
+                times.push_back(e.sample);
+        return times;
+    }
+};
+
+const std::vector<Chord> kProgression{{C, ChordType::Major}, {F, ChordType::Major}};
+
+} // anonymous namespace
+
+TEST_CASE("Triple buffer hands over only the latest value", "[strip_sequencer]") {
+    TripleBuffer<int> buffer;
+    REQUIRE(!buffer.update());
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+
+    REQUIRE(buffer.update());
+    REQUIRE(buffer.front() == 2);
+    REQUIRE(!buffer.update());
+    REQUIRE(buffer.front() == 2);
+}
+
+TEST_CASE("Chords change exactly on the bar at any block size", "[strip_sequencer]") {
+    // 120 BPM at 48 kHz: one 4/4 bar is 96000 samples
+    for (int blockSize : {64, 100, 512, 1237, 4096}) {
+        Host host(kProgression);
+        while (host.sample + blockSize <= 4 * 96000)
+            host.run(blockSize);
+
+        REQUIRE(host.noteOnTimes(60) == std::vector<long long>{0, 192000});
+        REQUIRE(host.noteOnTimes(65) == std::vector<long long>{96000, 288000});
+
+        // Each change releases the previous chord on the same sample, first
+        for (const auto& e : host.events)
+            if (!e.isNoteOn && e.note == 67)
+                REQUIRE((e.sample == 96000 || e.sample == 288000));
+    }
+}
+
+TEST_CASE("Recorded chord lengths override the bar", "[strip_sequencer]") {
+    auto progression = kProgression;
+    progression[0].lengthBeats = 2.0;
+    progression[1].lengthBeats = 1.0;
+    Host host(progression);
+    while (host.sample + 512 <= 96000)
+        host.run(512);
+
+    // 2 beats = 48000 samples, 1 beat = 24000
+    REQUIRE(host.noteOnTimes(60) == std::vector<long long>{0, 72000});
+    REQUIRE(host.noteOnTimes(65) == std::vector<long long>{48000});
+}
+
+TEST_CASE("Boundaries follow tempo changes", "[strip_sequencer]") {
+    Host host(kProgression);
+    host.run(48000);  // one second at 120 BPM = 2 beats
+    host.bpm = 60.0;
+    while (host.sample < 200000)
+        host.run(256);
+
+    // The remaining 2 beats take 2 s at 60 BPM
+    REQUIRE(host.noteOnTimes(65) == std::vector<long long>{48000 + 96000});
+}
+
+TEST_CASE("Stopping releases notes and a jump chases the step", "[strip_sequencer]") {
+    Host host(kProgression);
+    host.run(512);
+    host.playing = false;
+    host.run(512);
+
+    int offs = 0;
+    for (const auto& e : host.events)
+        if (!e.isNoteOn && e.sample == 512)
+            ++offs;
+    REQUIRE(offs == 3);
+    REQUIRE(!host.sequencer.isSounding());
+
+    host.playing = true;
+    host.ppq = 6.0;  // middle of the second bar
+    host.run(512);
+    REQUIRE(host.noteOnTimes(65) == std::vector<long long>{1024});
+}
+
+TEST_CASE("Sequence edits reach the audio thread", "[strip_sequencer]") {
+    Host host(kProgression);
+    host.run(512);
+    host.sequencer.publish(SequenceSnapshot::fromProgression({{G, ChordType::Major}}, true));
+    host.run(512);
+    REQUIRE(host.noteOnTimes(67) == std::vector<long long>{0, 512});
+    REQUIRE(host.noteOnTimes(71) == std::vector<long long>{512});
+
+    host.sequencer.publish(SequenceSnapshot::fromProgression({{G, ChordType::Major}}, false));
+    host.run(512);
+    REQUIRE(!host.sequencer.isSounding());
+}
+
+TEST_CASE("A progression longer than the strip's visible slots is played in full", "[strip_sequencer]") {
+    std::vector<Chord> take;
+    for (int i = 0; i < 12; ++i)
+        take.push_back({pitchClassFromSemitone(i), ChordType::Major});
+
+    auto snapshot = SequenceSnapshot::fromProgression(take, true);
+    REQUIRE(snapshot.numSteps == 12);
+    REQUIRE(snapshot.steps[11].numNotes == 3);
+    REQUIRE(snapshot.steps[11].notes[0] == take[11].midiNotes(4)[0]);
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+#include "engine/TaskPool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace chordpumper;
+
+TEST_CASE("parallelFor runs every index exactly once", "[task_pool]") {
+    TaskPool pool(4);
+    for (int numTasks : {0, 1, 7, 64, 1000}) {
+        std::vector<std::atomic<int>> runs(static_cast<size_t>(numTasks));
+        pool.parallelFor(numTasks, [&](int i) { runs[static_cast<size_t>(i)].fetch_add(1); });
+        for (const auto& count : runs)
+            REQUIRE(count.load() == 1);
+    }
+}
+
+TEST_CASE("Work spreads across threads", "[task_pool]") {
+    TaskPool pool(3);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+
+    pool.parallelFor(16, [&](int) {
+        int now = running.fetch_add(1) + 1;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        running.fetch_sub(1);
+    });
+    REQUIRE(peak.load() > 1);
+}
+
+TEST_CASE("Nested and concurrent batches complete", "[task_pool]") {
+    TaskPool pool(2);
+    std::atomic<int> total{0};
+
+    auto nested = [&] {
+        pool.parallelFor(8, [&](int) {
+            pool.parallelFor(8, [&](int) { total.fetch_add(1); });
+        });
+    };
+    std::thread other(nested);
+    nested();
+    other.join();
+
+    REQUIRE(total.load() == 2 * 8 * 8);
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+#include "diagnostics/Trace.h"
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace chordpumper;
+
+namespace {
+
+std::string dump() {
+    std::ostringstream out;
+    Trace::writeChromeJson(out);
+    return out.str();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Disabled trace scopes record nothing", "[trace]") {
+    Trace::setEnabled(false);
+    Trace::clear();
+    {
+        CHORDPUMPER_TRACE_SCOPE("disabledScope");
+    }
+    REQUIRE(dump().find("disabledScope") == std::string::npos);
+}
+
+TEST_CASE("Enabled scopes from several threads are exported as complete events", "[trace]") {
+    Trace::clear();
+    Trace::setEnabled(true);
+    {
+        CHORDPUMPER_TRACE_SCOPE("mainScope");
+    }
+    std::thread worker([] {
+        Trace::setThreadName("Worker");
+        CHORDPUMPER_TRACE_SCOPE("workerScope");
+    });
+    worker.join();
+    Trace::setEnabled(false);
+
+    auto json = dump();
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"mainScope\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"workerScope\"") != std::string::npos);
+    REQUIRE(json.find("\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"Worker\"") != std::string::npos);
+}
+
+TEST_CASE("Ring buffer keeps only the most recent events", "[trace]") {
+    Trace::clear();
+    Trace::setEnabled(true);
+    for (int i = 0; i < Trace::kEventsPerThread + 10; ++i) {
+        const char* name = i < 10 ? "oldest" : "recent";
+        int64_t t = Trace::now();
+        Trace::record(name, t, t + 1);
+    }
+    Trace::setEnabled(false);
+
+    auto json = dump();
+    REQUIRE(json.find("\"oldest\"") == std::string::npos);
+    REQUIRE(json.find("\"recent\"") != std::string::npos);
+}
+
+TEST_CASE("Threads that release their buffer hand it to later threads", "[trace]") {
+    Trace::clear();
+    Trace::setEnabled(true);
+    for (int i = 0; i < Trace::kMaxThreads * 2; ++i) {
+        std::thread worker([last = i == Trace::kMaxThreads * 2 - 1] {
+            {
+                CHORDPUMPER_TRACE_SCOPE(last ? "lastWorkerScope" : "workerScope");
+            }
+            Trace::releaseThread();
+        });
+        worker.join();
+    }
+    Trace::setEnabled(false);
+
+    REQUIRE(dump().find("\"name\":\"lastWorkerScope\"") != std::string::npos);
+}
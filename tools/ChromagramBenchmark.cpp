@@ -0,0 +1,122 @@
+// CPU budget check for the sidechain chromagram.
+//
+// Streams ten seconds of a synthetic C major / A minor progression through
+// ChromagramAnalyzer and ChordRecognizer::lookup at 48 kHz in 64-sample blocks,
+// the host setting the analysis budget is specified for, and fails if the
+// analysis of any one block costs more than 2% of that block's duration or
+// misses a chord change. The FFT runs in one block out of sixteen, so the peak
+// block rather than the average is what the budget has to hold for. Each
+// block's cost is its fastest of several passes, so preemption of the
+// benchmark itself does not register as a peak.
+
+#include "dsp/ChromagramAnalyzer.h"
+#include "engine/ChordRecognizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace chordpumper {
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int kBlockSize = 64;
+constexpr double kSeconds = 10.0;
+constexpr double kBudget = 0.02;
+constexpr int kPasses = 5;
+
+struct Segment
+{
+    int notes[3];
+    ChordId expected;
+};
+
+int run()
+{
+    const Segment progression[] = {
+        {{48, 64, 67}, makeChordId(0, ChordType::Major)},
+        {{45, 60, 64}, makeChordId(9, ChordType::Minor)},
+    };
+    const int numBlocks = static_cast<int>(kSeconds * kSampleRate) / kBlockSize;
+    const int blocksPerSegment = static_cast<int>(kSampleRate) / kBlockSize;
+
+    // Render everything up front so only the analysis is timed
+    std::vector<float> left(static_cast<size_t>(numBlocks * kBlockSize));
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        const auto& segment = progression[(i / static_cast<size_t>(kBlockSize * blocksPerSegment)) % 2];
+        const double t = static_cast<double>(i) / kSampleRate;
+        double value = 0.0;
+        for (int note : segment.notes)
+            value += 0.1 * std::sin(2.0 * 3.141592653589793 * 440.0 * std::exp2((note - 69) / 12.0) * t);
+        left[i] = static_cast<float>(value);
+    }
+    const std::vector<float> right = left;
+
+    ChromagramAnalyzer analyzer;
+    analyzer.prepare(kSampleRate, kBlockSize);
+
+    int heardChanges = 0;
+    int wrongChords = 0;
+    std::vector<std::chrono::steady_clock::duration> blockCost(
+        static_cast<size_t>(numBlocks), std::chrono::steady_clock::duration::max());
+
+    for (int pass = 0; pass < kPasses; ++pass)
+    {
+        analyzer.reset();
+        ChordId lastHeard = kNoChord;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const size_t offset = static_cast<size_t>(block * kBlockSize);
+            const float* channels[] = {left.data() + offset, right.data() + offset};
+
+            const auto start = std::chrono::steady_clock::now();
+            bool analysed = analyzer.process(channels, 2, kBlockSize);
+            RecognizedChord heard;
+            if (analysed)
+                heard = ChordRecognizer::lookup(analyzer.activePitchClasses(), analyzer.chordBassPitchClass());
+            auto& cost = blockCost[static_cast<size_t>(block)];
+            cost = std::min(cost, std::chrono::steady_clock::now() - start);
+
+            if (pass > 0 || !heard.isValid() || heard.id == lastHeard)
+                continue;
+            lastHeard = heard.id;
+            ++heardChanges;
+
+            const auto& expected = progression[(block / blocksPerSegment) % 2];
+            if (heard.id != expected.expected)
+                ++wrongChords;
+        }
+    }
+
+    std::chrono::steady_clock::duration total{};
+    std::chrono::steady_clock::duration peak{};
+    for (const auto& cost : blockCost)
+    {
+        total += cost;
+        peak = std::max(peak, cost);
+    }
+
+    const double blockSeconds = kBlockSize / kSampleRate;
+    const double load = std::chrono::duration<double>(total).count() / kSeconds;
+    const double peakLoad = std::chrono::duration<double>(peak).count() / blockSeconds;
+    const int segments = numBlocks / blocksPerSegment;
+    std::printf("chromagram: %.3f%% of realtime on average, %.3f%% in the slowest block "
+                "at %.0f Hz / %d samples (budget %.1f%%), %d/%d chord changes, %d wrong\n",
+                100.0 * load, 100.0 * peakLoad, kSampleRate, kBlockSize, 100.0 * kBudget,
+                heardChanges, segments, wrongChords);
+
+    if (peakLoad >= kBudget || heardChanges != segments || wrongChords != 0)
+        return 1;
+    return 0;
+}
+
+} // anonymous namespace
+} // namespace chordpumper
+
+int main()
+{
+    return chordpumper::run();
+}
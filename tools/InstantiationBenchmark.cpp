@@ -0,0 +1,169 @@
+// Instantiation latency check.
+//
+// Creates a project's worth of instances the way a host loading a session
+// does: construct the processor, restore a morphed state with a full
+// progression, and optionally open the editor (64 pads and the look and feel).
+// Every instance stays alive until the end, as in a project. Reports each
+// phase and fails if restoring an instance costs 5 ms or more, either for the
+// first instance (which pays for process-wide setup) or the median one.
+
+#include "PluginProcessor.h"
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace chordpumper {
+namespace {
+
+constexpr double kBudgetMs = 5.0;
+
+struct Options
+{
+    int instances = 20;
+    bool openEditors = true;
+};
+
+void printUsage()
+{
+    std::puts("Usage: ChordPumperInstantiationBenchmark [options]\n"
+              "  --instances <n>   instances to create, default 20\n"
+              "  --no-editor       skip opening editors (a headless scan)");
+}
+
+bool parseOptions(const juce::StringArray& args, Options& opts)
+{
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        if (arg == "--instances" && i + 1 < args.size()) opts.instances = args[++i].getIntValue();
+        else if (arg == "--no-editor")                   opts.openEditors = false;
+        else
+        {
+            std::fprintf(stderr, "Unknown option: %s\n", arg.toRawUTF8());
+            return false;
+        }
+    }
+    return opts.instances > 0;
+}
+
+double elapsedMs(juce::int64 start)
+{
+    return 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+    auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+// A session as a user leaves it: grid morphed away from the palette and a
+// full progression on the strip.
+juce::MemoryBlock makeSession()
+{
+    ChordPumperProcessor source;
+    {
+        const juce::ScopedLock sl(source.getStateLock());
+        auto& state = source.getState();
+        MorphEngine engine;
+        const Chord reference{pitches::A, ChordType::Min7};
+        const auto notes = reference.midiNotes(4);
+        state.lastVoicing.assign(notes.begin(), notes.end());
+        auto suggestions = engine.morph(reference, state.lastVoicing, static_cast<size_t>(state.gridSize.cells()));
+        for (size_t i = 0; i < suggestions.size(); ++i)
+        {
+            state.gridChords[i] = suggestions[i].chord;
+            state.romanNumerals[i] = suggestions[i].romanNumeral;
+        }
+        state.lastPlayedChord = reference;
+        state.hasMorphed = true;
+        for (size_t i = 0; i < 8; ++i)
+            state.progression.push_back(suggestions[i % suggestions.size()].chord);
+    }
+
+    juce::MemoryBlock session;
+    source.getStateInformation(session);
+    return session;
+}
+
+void report(const char* phase, const std::vector<double>& ms)
+{
+    if (ms.empty())
+        return;
+    std::printf("%-10s first %7.3f ms, median %7.3f ms, max %7.3f ms\n", phase, ms.front(), median(ms),
+                *std::max_element(ms.begin(), ms.end()));
+}
+
+int run(const Options& opts)
+{
+    const auto session = makeSession();
+    const auto numInstances = static_cast<size_t>(opts.instances);
+
+    std::vector<std::unique_ptr<ChordPumperProcessor>> processors;
+    std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+    std::vector<double> constructMs, restoreMs, editorMs, coldLoadMs;
+    processors.reserve(numInstances);
+    editors.reserve(numInstances);
+
+    for (size_t i = 0; i < numInstances; ++i)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        processors.push_back(std::make_unique<ChordPumperProcessor>());
+        constructMs.push_back(elapsedMs(start));
+
+        start = juce::Time::getHighResolutionTicks();
+        processors.back()->setStateInformation(session.getData(), static_cast<int>(session.getSize()));
+        restoreMs.push_back(elapsedMs(start));
+        coldLoadMs.push_back(constructMs.back() + restoreMs.back());
+
+        if (opts.openEditors)
+        {
+            start = juce::Time::getHighResolutionTicks();
+            editors.emplace_back(processors.back()->createEditor());
+            editorMs.push_back(elapsedMs(start));
+        }
+    }
+
+    auto start = juce::Time::getHighResolutionTicks();
+    editors.clear();
+    processors.clear();
+    const double teardownMs = elapsedMs(start);
+
+    std::printf("instances: %zu, session %zu bytes\n", numInstances, session.getSize());
+    report("construct", constructMs);
+    report("restore", restoreMs);
+    report("cold load", coldLoadMs);
+    report("editor", editorMs);
+    std::printf("teardown   %7.3f ms for all instances\n", teardownMs);
+    std::printf("budget     %.1f ms per cold load\n", kBudgetMs);
+
+    if (coldLoadMs.front() >= kBudgetMs || median(coldLoadMs) >= kBudgetMs)
+        return 1;
+    return 0;
+}
+
+} // anonymous namespace
+} // namespace chordpumper
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    chordpumper::Options opts;
+    if (!chordpumper::parseOptions(args, opts))
+    {
+        chordpumper::printUsage();
+        return 2;
+    }
+
+    return chordpumper::run(opts);
+}
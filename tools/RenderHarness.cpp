@@ -0,0 +1,347 @@
+// Headless driver for ChordPumperProcessor::processBlock.
+//
+// Streams a MIDI file, an event script or a randomised pad performance through
+// the processor faster than realtime, optionally at randomised buffer sizes,
+// writes the produced MIDI and reports per-block CPU time percentiles.
+//
+// Script format (one event per line, '#' starts a comment):
+//     <seconds> on  <note> [velocity] [ui|midi]
+//     <seconds> off <note>            [ui|midi]
+// "ui" events go through the same path as a pad click, "midi" events arrive
+// in the host MIDI buffer. The default is "ui".
+//
+// With --realtime-check the harness must be linked with RealtimeHooks.cpp; any
+// allocation or mutex acquisition inside processBlock fails the run.
+
+#include "PluginProcessor.h"
+#include "diagnostics/RealtimeGuard.h"
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace chordpumper {
+namespace {
+
+struct Options
+{
+    juce::File midiIn;
+    juce::File script;
+    juce::File midiOut;
+    double syntheticSeconds = 0.0;
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int minBlock = 0;
+    int maxBlock = 0;
+    juce::int64 seed = 1;
+    bool realtimeCheck = false;
+};
+
+struct ScriptEvent
+{
+    double seconds;
+    juce::MidiMessage message;
+    bool viaUi;
+};
+
+void printUsage()
+{
+    std::puts("Usage: ChordPumperRenderHarness [options]\n"
+              "  --midi <file>              stream a MIDI file into the processor\n"
+              "  --script <file>            stream an event script into the processor\n"
+              "  --synthetic <seconds>      generate a random pad performance\n"
+              "  --out <file>               write the processor's MIDI output\n"
+              "  --sample-rate <hz>         default 48000\n"
+              "  --block <samples>          fixed buffer size, default 512\n"
+              "  --random-blocks <min> <max> randomise the buffer size per block\n"
+              "  --seed <n>                 seed for --synthetic and --random-blocks\n"
+              "  --realtime-check           fail if processBlock allocates or takes a lock");
+}
+
+bool parseOptions(const juce::StringArray& args, Options& opts)
+{
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        auto next = [&]() -> juce::String { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+        if (arg == "--midi")               opts.midiIn = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        else if (arg == "--script")        opts.script = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        else if (arg == "--out")           opts.midiOut = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        else if (arg == "--synthetic")     opts.syntheticSeconds = next().getDoubleValue();
+        else if (arg == "--sample-rate")   opts.sampleRate = next().getDoubleValue();
+        else if (arg == "--block")         opts.blockSize = next().getIntValue();
+        else if (arg == "--seed")          opts.seed = next().getLargeIntValue();
+        else if (arg == "--realtime-check") opts.realtimeCheck = true;
+        else if (arg == "--random-blocks")
+        {
+            opts.minBlock = next().getIntValue();
+            opts.maxBlock = next().getIntValue();
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown option: %s\n", arg.toRawUTF8());
+            return false;
+        }
+    }
+
+    if (opts.sampleRate <= 0.0 || opts.blockSize <= 0)
+        return false;
+    if (opts.maxBlock > 0 && (opts.minBlock <= 0 || opts.minBlock > opts.maxBlock))
+        return false;
+
+    return opts.midiIn != juce::File() || opts.script != juce::File() || opts.syntheticSeconds > 0.0;
+}
+
+void loadMidiFile(const juce::File& file, std::vector<ScriptEvent>& events)
+{
+    juce::FileInputStream stream(file);
+    juce::MidiFile midi;
+    if (!stream.openedOk() || !midi.readFrom(stream))
+    {
+        std::fprintf(stderr, "Could not read MIDI file: %s\n", file.getFullPathName().toRawUTF8());
+        return;
+    }
+
+    midi.convertTimestampTicksToSeconds();
+    for (int t = 0; t < midi.getNumTracks(); ++t)
+    {
+        for (const auto* holder : *midi.getTrack(t))
+        {
+            const auto& msg = holder->message;
+            if (msg.isMetaEvent())
+                continue;
+            events.push_back({msg.getTimeStamp(), msg, false});
+        }
+    }
+}
+
+void loadScript(const juce::File& file, std::vector<ScriptEvent>& events)
+{
+    juce::StringArray lines;
+    file.readLines(lines);
+
+    for (const auto& raw : lines)
+    {
+        auto line = raw.upToFirstOccurrenceOf("#", false, false).trim();
+        if (line.isEmpty())
+            continue;
+
+        auto tokens = juce::StringArray::fromTokens(line, " \t", "");
+        tokens.removeEmptyStrings();
+        if (tokens.size() < 3)
+            continue;
+
+        double seconds = tokens[0].getDoubleValue();
+        bool isOn = tokens[1] == "on";
+        int note = juce::jlimit(0, 127, tokens[2].getIntValue());
+        int argIndex = 3;
+        float velocity = 0.8f;
+        if (isOn && tokens.size() > argIndex && tokens[argIndex].containsOnly("0123456789"))
+            velocity = static_cast<float>(tokens[argIndex++].getIntValue()) / 127.0f;
+        bool viaUi = !(tokens.size() > argIndex && tokens[argIndex] == "midi");
+
+        auto msg = isOn ? juce::MidiMessage::noteOn(1, note, velocity)
+                        : juce::MidiMessage::noteOff(1, note, 0.0f);
+        events.push_back({seconds, msg, viaUi});
+    }
+}
+
+void generateSynthetic(double seconds, juce::Random& rng, std::vector<ScriptEvent>& events)
+{
+    static constexpr int kShapes[][4] = {
+        {0, 4, 7, -1}, {0, 3, 7, -1}, {0, 4, 7, 11}, {0, 3, 7, 10}, {0, 4, 7, 10}
+    };
+
+    double t = 0.0;
+    while (t < seconds)
+    {
+        int root = 48 + rng.nextInt(24);
+        const auto& shape = kShapes[rng.nextInt(5)];
+        double length = 0.05 + rng.nextDouble() * 0.4;
+
+        for (int interval : shape)
+        {
+            if (interval < 0)
+                continue;
+            events.push_back({t, juce::MidiMessage::noteOn(1, root + interval, 0.8f), true});
+            events.push_back({t + length, juce::MidiMessage::noteOff(1, root + interval, 0.0f), true});
+        }
+        t += length + rng.nextDouble() * 0.1;
+    }
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    auto rank = static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + static_cast<ptrdiff_t>(rank), values.end());
+    return values[rank];
+}
+
+int run(const Options& opts)
+{
+    std::vector<ScriptEvent> events;
+    juce::Random rng(opts.seed);
+
+    if (opts.midiIn != juce::File())         loadMidiFile(opts.midiIn, events);
+    if (opts.script != juce::File())         loadScript(opts.script, events);
+    if (opts.syntheticSeconds > 0.0)         generateSynthetic(opts.syntheticSeconds, rng, events);
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const ScriptEvent& a, const ScriptEvent& b) { return a.seconds < b.seconds; });
+
+    const double endSeconds = (events.empty() ? 0.0 : events.back().seconds) + 0.5;
+    const auto totalSamples = static_cast<juce::int64>(endSeconds * opts.sampleRate);
+    const int maxBlock = opts.maxBlock > 0 ? opts.maxBlock : opts.blockSize;
+
+    ChordPumperProcessor processor;
+    processor.setPlayConfigDetails(0, 2, opts.sampleRate, maxBlock);
+    processor.prepareToPlay(opts.sampleRate, maxBlock);
+
+    juce::AudioBuffer<float> audio(2, maxBlock);
+    // Like a host, size the buffer for the input only; the processor must not
+    // grow it to fit what it adds.
+    juce::MidiBuffer midi;
+    midi.ensureSize(64);
+
+    juce::MidiMessageSequence output;
+    const int minBlock = opts.maxBlock > 0 ? opts.minBlock : opts.blockSize;
+    std::vector<double> blockMs;
+    blockMs.reserve(static_cast<size_t>(totalSamples / minBlock + 1));
+    double periodMsSum = 0.0;
+
+    size_t nextEvent = 0;
+    juce::int64 position = 0;
+
+    RealtimeGuard::warmUp();
+    RealtimeGuard::reset();
+
+    while (position < totalSamples)
+    {
+        int numSamples = opts.maxBlock > 0 ? opts.minBlock + rng.nextInt(opts.maxBlock - opts.minBlock + 1)
+                                           : opts.blockSize;
+        numSamples = static_cast<int>(std::min<juce::int64>(numSamples, totalSamples - position));
+
+        midi.clear();
+        const auto blockEnd = position + numSamples;
+        while (nextEvent < events.size())
+        {
+            const auto& ev = events[nextEvent];
+            auto samplePos = static_cast<juce::int64>(ev.seconds * opts.sampleRate);
+            if (samplePos >= blockEnd)
+                break;
+
+            if (ev.viaUi)
+            {
+                auto& queue = processor.getPreviewQueue();
+                if (ev.message.isNoteOn())
+                    queue.noteOn(ev.message.getChannel(), ev.message.getNoteNumber(), ev.message.getFloatVelocity());
+                else if (ev.message.isNoteOff())
+                    queue.noteOff(ev.message.getChannel(), ev.message.getNoteNumber());
+            }
+            else
+            {
+                midi.addEvent(ev.message, static_cast<int>(std::max<juce::int64>(0, samplePos - position)));
+            }
+            ++nextEvent;
+        }
+
+        juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), audio.getNumChannels(), numSamples);
+
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(block, midi);
+        auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        blockMs.push_back(elapsed * 1000.0);
+        periodMsSum += 1000.0 * numSamples / opts.sampleRate;
+
+        for (const auto metadata : midi)
+        {
+            auto msg = metadata.getMessage();
+            msg.setTimeStamp(static_cast<double>(position + metadata.samplePosition) / opts.sampleRate);
+            output.addEvent(msg);
+        }
+
+        position = blockEnd;
+    }
+
+    processor.releaseResources();
+
+    const int violations = RealtimeGuard::getNumViolations();
+
+    if (opts.midiOut != juce::File())
+    {
+        // 120 BPM at 960 PPQ: one second is 1920 ticks
+        constexpr int kTicksPerQuarterNote = 960;
+        constexpr double kTicksPerSecond = 2.0 * kTicksPerQuarterNote;
+
+        juce::MidiMessageSequence track;
+        track.addEvent(juce::MidiMessage::tempoMetaEvent(500000), 0.0);
+        for (const auto* holder : output)
+        {
+            auto msg = holder->message;
+            msg.setTimeStamp(msg.getTimeStamp() * kTicksPerSecond);
+            track.addEvent(msg);
+        }
+        track.updateMatchedPairs();
+
+        juce::MidiFile file;
+        file.setTicksPerQuarterNote(kTicksPerQuarterNote);
+        file.addTrack(track);
+
+        opts.midiOut.deleteFile();
+        if (auto stream = opts.midiOut.createOutputStream(); stream == nullptr || !file.writeTo(*stream))
+        {
+            std::fprintf(stderr, "Could not write %s\n", opts.midiOut.getFullPathName().toRawUTF8());
+            return 1;
+        }
+    }
+
+    const double avgPeriodMs = blockMs.empty() ? 0.0 : periodMsSum / static_cast<double>(blockMs.size());
+    const double p50 = percentile(blockMs, 0.50);
+    const double p99 = percentile(blockMs, 0.99);
+    const double max = blockMs.empty() ? 0.0 : *std::max_element(blockMs.begin(), blockMs.end());
+
+    std::printf("blocks:       %zu (%.1f s of audio, %d events in, %d events out)\n",
+                blockMs.size(), static_cast<double>(totalSamples) / opts.sampleRate,
+                static_cast<int>(events.size()), output.getNumEvents());
+    std::printf("block period: %.3f ms avg\n", avgPeriodMs);
+    std::printf("cpu p50:      %.4f ms\n", p50);
+    std::printf("cpu p99:      %.4f ms\n", p99);
+    std::printf("cpu max:      %.4f ms (%.2f%% of avg period)\n", max,
+                avgPeriodMs > 0.0 ? 100.0 * max / avgPeriodMs : 0.0);
+
+    if (opts.realtimeCheck)
+    {
+        std::printf("realtime:     %d violation(s) inside processBlock\n", violations);
+        if (violations > 0)
+        {
+            std::fputs(RealtimeGuard::describe().c_str(), stderr);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+} // anonymous namespace
+} // namespace chordpumper
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    chordpumper::Options opts;
+    if (!chordpumper::parseOptions(args, opts))
+    {
+        chordpumper::printUsage();
+        return 2;
+    }
+
+    return chordpumper::run(opts);
+}